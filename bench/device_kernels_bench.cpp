@@ -0,0 +1,153 @@
+// Microbenchmark: batched diode/MOSFET kernels against the per-quantity
+// scalar methods and the fused evaluate() of the element classes.
+//
+// Usage: device_kernels_bench [devices] [repetitions]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "parser/circuit_element.h"
+#include "simulation/device_kernels.h"
+
+namespace {
+
+volatile double sink;
+
+template <typename F>
+double bestSeconds(int repetitions, F&& body) {
+    double best = 1e30;
+    for (int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+double relativeError(double a, double b) {
+    if (a == b) return 0.0;
+    return std::abs(a - b) / std::max(std::abs(a), std::abs(b));
+}
+
+void report(const char* name, double scalar, double fused, double batched, std::size_t n, double error) {
+    std::printf("%-8s scalar %8.2f ns/dev   fused %8.2f ns/dev   batched %8.2f ns/dev   "
+                "speedup %5.2fx   max rel err %.2e\n",
+                name, 1e9 * scalar / n, 1e9 * fused / n, 1e9 * batched / n, scalar / batched, error);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> diodeVoltage(-1.0, 0.9);
+    std::uniform_real_distribution<double> gateVoltage(0.0, 3.3);
+    std::uniform_real_distribution<double> drainVoltage(0.0, 3.3);
+
+    // Diodes
+    Diode diode("D1");
+    std::vector<double> v(n), Is(n, diode.Is), nVt(n, diode.n * diode.Vt);
+    std::vector<double> reverseLimit(n, -5.0 * diode.n * diode.Vt);
+    for (auto& x : v) x = diodeVoltage(rng);
+
+    std::vector<double> iRef(n), gRef(n), iBatch(n), gBatch(n);
+    double diodeScalar = bestSeconds(repetitions, [&] {
+        for (std::size_t i = 0; i < n; i++) {
+            iRef[i] = diode.getCurrent(v[i]);
+            gRef[i] = diode.getConductance(v[i]);
+        }
+        sink = iRef[n / 2];
+    });
+    double diodeFused = bestSeconds(repetitions, [&] {
+        for (std::size_t i = 0; i < n; i++) {
+            Diode::OperatingPoint op = diode.evaluate(v[i]);
+            iBatch[i] = op.current;
+            gBatch[i] = op.conductance;
+        }
+        sink = iBatch[n / 2];
+    });
+    double diodeBatched = bestSeconds(repetitions, [&] {
+        evaluateDiodes(n, v.data(), Is.data(), nVt.data(), reverseLimit.data(),
+                       iBatch.data(), gBatch.data());
+        sink = iBatch[n / 2];
+    });
+    double diodeError = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        diodeError = std::max({diodeError, relativeError(iRef[i], iBatch[i]),
+                               relativeError(gRef[i], gBatch[i])});
+    }
+
+    // NMOS
+    NMOSFET mosfet("M1");
+    std::vector<double> vgs(n), vds(n);
+    std::vector<double> beta(n, mosfet.Kn * (mosfet.W / mosfet.L)), Vth(n, mosfet.Vth), lambda(n, mosfet.lambda);
+    for (std::size_t i = 0; i < n; i++) {
+        vgs[i] = gateVoltage(rng);
+        vds[i] = drainVoltage(rng);
+    }
+
+    std::vector<double> idRef(n), gmRef(n), gdsRef(n), idBatch(n), gmBatch(n), gdsBatch(n);
+    double mosScalar = bestSeconds(repetitions, [&] {
+        for (std::size_t i = 0; i < n; i++) {
+            idRef[i] = mosfet.getDrainCurrent(vgs[i], vds[i]);
+            gmRef[i] = mosfet.getTransconductance(vgs[i], vds[i]);
+            gdsRef[i] = mosfet.getOutputConductance(vgs[i], vds[i]);
+        }
+        sink = idRef[n / 2];
+    });
+    double mosFused = bestSeconds(repetitions, [&] {
+        for (std::size_t i = 0; i < n; i++) {
+            NMOSFET::OperatingPoint op = mosfet.evaluate(vgs[i], vds[i]);
+            idBatch[i] = op.id;
+            gmBatch[i] = op.gm;
+            gdsBatch[i] = op.gds;
+        }
+        sink = idBatch[n / 2];
+    });
+    double mosBatched = bestSeconds(repetitions, [&] {
+        evaluateMOSFETs(n, vgs.data(), vds.data(), beta.data(), Vth.data(), lambda.data(),
+                        idBatch.data(), gmBatch.data(), gdsBatch.data());
+        sink = idBatch[n / 2];
+    });
+    double mosError = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        mosError = std::max({mosError, relativeError(idRef[i], idBatch[i]),
+                             relativeError(gmRef[i], gmBatch[i]),
+                             relativeError(gdsRef[i], gdsBatch[i])});
+    }
+
+    // exp alone
+    std::vector<double> x(n), yRef(n), yBatch(n);
+    std::uniform_real_distribution<double> expArgument(-700.0, 700.0);
+    for (auto& a : x) a = expArgument(rng);
+    double expScalar = bestSeconds(repetitions, [&] {
+        for (std::size_t i = 0; i < n; i++) yRef[i] = std::exp(x[i]);
+        sink = yRef[n / 2];
+    });
+    double expBatched = bestSeconds(repetitions, [&] {
+        batchExp(n, x.data(), yBatch.data());
+        sink = yBatch[n / 2];
+    });
+    double expError = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        expError = std::max(expError, relativeError(yRef[i], yBatch[i]));
+    }
+
+#if defined(__AVX2__)
+    const char* isa = "AVX2";
+#else
+    const char* isa = "scalar lanes";
+#endif
+    std::printf("%zu devices, best of %d runs, batched kernels: %s\n", n, repetitions, isa);
+    report("exp", expScalar, expScalar, expBatched, n, expError);
+    report("diode", diodeScalar, diodeFused, diodeBatched, n, diodeError);
+    report("nmos", mosScalar, mosFused, mosBatched, n, mosError);
+    return 0;
+}
@@ -0,0 +1,271 @@
+// Scaling benchmark: generates parametric netlists, then times parsing, the
+// DC operating point and a fixed-step transient run for each.
+//
+// Usage: spice_bench [--format json|csv] [--min N] [--max N] [--steps N]
+//                    [--repeat N] [--family NAME]... [--output FILE]
+//
+// Families: rc_ladder, mesh, lc_line, diode_bank, inverter_chain. Sizes are
+// element counts, stepping by powers of ten from --min (default 10) to
+// --max (default 100000; up to 1000000). Each measurement is the best of
+// --repeat runs.
+//
+// Exits with status 1 if any run fails its DC operating point or initial
+// conditions, or rejects a transient step.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "parser/spice_parser.h"
+#include "util/log.h"
+
+namespace {
+
+using Generator = std::function<void(std::ostream&, long)>;
+
+struct Family {
+    const char* name;
+    Generator generate;
+    double stepTime;
+};
+
+// Voltage-driven RC ladder: one R and one C per section
+void rcLadder(std::ostream& out, long elements) {
+    long sections = std::max(1L, (elements - 1) / 2);
+    out << "V1 n0 0 1\n";
+    for (long k = 1; k <= sections; k++) {
+        out << "R" << k << " n" << k - 1 << " n" << k << " 1k\n";
+        out << "C" << k << " n" << k << " 0 1n\n";
+    }
+}
+
+// Square resistor grid driven at one corner, loaded at the other
+void mesh(std::ostream& out, long elements) {
+    long side = std::max(2L, std::lround(std::sqrt(elements / 2.0)));
+    auto node = [side](long r, long c) { return "m" + std::to_string(r * side + c); };
+    out << "V1 " << node(0, 0) << " 0 1\n";
+    long id = 0;
+    for (long r = 0; r < side; r++) {
+        for (long c = 0; c < side; c++) {
+            if (c + 1 < side) out << "R" << ++id << " " << node(r, c) << " " << node(r, c + 1) << " 100\n";
+            if (r + 1 < side) out << "R" << ++id << " " << node(r, c) << " " << node(r + 1, c) << " 100\n";
+        }
+    }
+    out << "RL " << node(side - 1, side - 1) << " 0 1k\n";
+}
+
+// Terminated lossy LC transmission line model. The shunt leakage gives every
+// section a DC path while inductors are open for the initial conditions.
+void lcLine(std::ostream& out, long elements) {
+    long sections = std::max(1L, (elements - 3) / 3);
+    out << "V1 in 0 1\n";
+    out << "RS in l0 50\n";
+    for (long k = 1; k <= sections; k++) {
+        out << "L" << k << " l" << k - 1 << " l" << k << " 10n\n";
+        out << "C" << k << " l" << k << " 0 4p\n";
+        out << "RG" << k << " l" << k << " 0 1meg\n";
+    }
+    out << "RL l" << sections << " 0 50\n";
+}
+
+// Half-wave rectifier branches sharing one source
+void diodeBank(std::ostream& out, long elements) {
+    long branches = std::max(1L, (elements - 1) / 3);
+    out << "V1 in 0 5\n";
+    for (long k = 1; k <= branches; k++) {
+        out << "D" << k << " in o" << k << " dmod\n";
+        out << "C" << k << " o" << k << " 0 1u\n";
+        out << "R" << k << " o" << k << " 0 1k\n";
+    }
+}
+
+// Resistor-load NMOS inverter chain with a load capacitor per stage. The
+// simulator does not stamp PMOS devices yet, so a CMOS chain would leave every
+// stage output floating.
+void inverterChain(std::ostream& out, long elements) {
+    long stages = std::max(1L, (elements - 2) / 3);
+    out << "VDD vdd 0 3.3\n";
+    out << "VIN s0 0 3.3\n";
+    for (long k = 1; k <= stages; k++) {
+        out << "RD" << k << " vdd s" << k << " 10k\n";
+        out << "MN" << k << " s" << k << " s" << k - 1 << " 0 0 nmos\n";
+        out << "CL" << k << " s" << k << " 0 1p\n";
+    }
+}
+
+const Family families[] = {
+    {"rc_ladder", rcLadder, 1e-7},
+    {"mesh", mesh, 1e-7},
+    {"lc_line", lcLine, 1e-11},
+    {"diode_bank", diodeBank, 1e-5},
+    {"inverter_chain", inverterChain, 1e-12},
+};
+
+struct Result {
+    std::string family;
+    long elements = 0;
+    int nodes = 0;
+    int unknowns = 0;
+    long long matrixNonZeros = 0;
+    long long factorNonZeros = 0;
+    double parseSeconds = 0.0;
+    double dcSeconds = 0.0;
+    double transientSeconds = 0.0;
+    long long timeSteps = 0;
+    bool dcSolved = false;            // false if the DC matrix was singular
+    bool icSolved = false;            // false if the transient start-up matrix was
+    long long rejectedSteps = 0;
+};
+
+template <typename F>
+double bestSeconds(int repetitions, F&& body) {
+    double best = 1e30;
+    for (int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+Result run(const Family& family, long elements, int steps, int repetitions) {
+    Result result;
+    result.family = family.name;
+
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("spice_bench_" + std::string(family.name) + ".cir")).string();
+    {
+        std::ofstream file(path);
+        file << "* " << family.name << " " << elements << "\n";
+        family.generate(file, elements);
+        file << ".end\n";
+    }
+
+    SPICEParser parser;
+    result.parseSeconds = bestSeconds(repetitions, [&] { parser.parseFile(path); });
+    std::remove(path.c_str());
+
+    const auto& circuit = parser.getElements();
+    result.elements = static_cast<long>(circuit.size());
+    result.nodes = parser.getNumNodes();
+
+    DCAnalysis dc(circuit, parser.getNumNodes());
+    result.dcSeconds = bestSeconds(repetitions, [&] { dc.solve(); });
+    result.unknowns = dc.getStats().matrixSize;
+    result.matrixNonZeros = dc.getStats().matrixNonZeros;
+    result.factorNonZeros = dc.getStats().factorNonZeros;
+    result.dcSolved = dc.hasSolution();
+
+    TransientSettings settings(family.stepTime, family.stepTime * steps);
+    result.transientSeconds = bestSeconds(repetitions, [&] {
+        TransientAnalysis transient(circuit, parser.getNumNodes(), settings);
+        transient.solve();
+        result.timeSteps = transient.getStats().timeSteps;
+        result.rejectedSteps = transient.getStats().rejectedSteps;
+        result.icSolved = transient.hasInitialConditions();
+    });
+    return result;
+}
+
+void writeCsv(std::ostream& out, const std::vector<Result>& results) {
+    out << "family,elements,nodes,unknowns,matrix_nnz,factor_nnz,parse_s,dc_s,transient_s,"
+           "time_steps,dc_solved,ic_solved,rejected_steps\n";
+    for (const Result& r : results) {
+        out << r.family << ',' << r.elements << ',' << r.nodes << ',' << r.unknowns << ','
+            << r.matrixNonZeros << ',' << r.factorNonZeros << ',' << r.parseSeconds << ','
+            << r.dcSeconds << ',' << r.transientSeconds << ',' << r.timeSteps << ','
+            << (r.dcSolved ? 1 : 0) << ',' << (r.icSolved ? 1 : 0) << ',' << r.rejectedSteps << '\n';
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "  {\"family\": \"" << r.family << "\", \"elements\": " << r.elements
+            << ", \"nodes\": " << r.nodes << ", \"unknowns\": " << r.unknowns
+            << ", \"matrix_nnz\": " << r.matrixNonZeros << ", \"factor_nnz\": " << r.factorNonZeros
+            << ", \"parse_s\": " << r.parseSeconds << ", \"dc_s\": " << r.dcSeconds
+            << ", \"transient_s\": " << r.transientSeconds << ", \"time_steps\": " << r.timeSteps
+            << ", \"dc_solved\": " << (r.dcSolved ? "true" : "false")
+            << ", \"ic_solved\": " << (r.icSolved ? "true" : "false")
+            << ", \"rejected_steps\": " << r.rejectedSteps << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: spice_bench [--format json|csv] [--min N] [--max N] [--steps N]\n"
+                         "                   [--repeat N] [--family NAME]... [--output FILE]\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string format = "json";
+    std::string output;
+    long minElements = 10, maxElements = 100000;
+    int steps = 20, repetitions = 1;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return usage();
+        const char* value = argv[++i];
+        if (arg == "--format") format = value;
+        else if (arg == "--output") output = value;
+        else if (arg == "--min") minElements = std::atol(value);
+        else if (arg == "--max") maxElements = std::atol(value);
+        else if (arg == "--steps") steps = std::atoi(value);
+        else if (arg == "--repeat") repetitions = std::max(1, std::atoi(value));
+        else if (arg == "--family") selected.push_back(value);
+        else return usage();
+    }
+    if (format != "json" && format != "csv") return usage();
+
+    // Analysis chatter and result tables would dominate the timings
+    Log::setLevel(LogLevel::Error);
+
+    std::vector<Result> results;
+    for (const Family& family : families) {
+        if (!selected.empty() &&
+            std::find(selected.begin(), selected.end(), family.name) == selected.end()) {
+            continue;
+        }
+        for (long n = minElements; n <= maxElements; n *= 10) {
+            std::fprintf(stderr, "%s %ld...\n", family.name, n);
+            results.push_back(run(family, n, steps, repetitions));
+        }
+    }
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output);
+        if (!file.is_open()) {
+            std::fprintf(stderr, "cannot write %s\n", output.c_str());
+            return 1;
+        }
+    }
+    std::ostream& out = output.empty() ? std::cout : file;
+    if (format == "csv") writeCsv(out, results);
+    else writeJson(out, results);
+
+    bool ok = true;
+    for (const Result& r : results) {
+        if (!r.dcSolved || !r.icSolved || r.rejectedSteps > 0) {
+            std::fprintf(stderr, "%s %ld: dc_solved=%d ic_solved=%d rejected_steps=%lld\n", r.family.c_str(),
+                         r.elements, r.dcSolved ? 1 : 0, r.icSolved ? 1 : 0, r.rejectedSteps);
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+// Waveform compression check and benchmark: round-trips typical and
+// adversarial signals through WaveformCodec, a compressed and spilled
+// WaveformStore and .spw files (packed and raw), comparing every sample bit
+// for bit, then times encode and decode per signal kind.
+//
+// Usage: waveform_codec_bench [samples] [repetitions]
+//
+// Exits with status 1 if any round trip changes a sample.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "simulation/waveform_codec.h"
+#include "simulation/waveform_file.h"
+#include "simulation/waveform_store.h"
+
+namespace {
+
+struct Signal {
+    std::string name;
+    std::vector<double> values;
+};
+
+template <typename F>
+double bestSeconds(int repetitions, F&& body) {
+    double best = 1e30;
+    for (int r = 0; r < repetitions; r++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+double fromBits(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool sameBits(const double* a, const double* b, std::size_t count) {
+    return count == 0 || std::memcmp(a, b, count * sizeof(double)) == 0;
+}
+
+std::vector<Signal> makeSignals(std::size_t n) {
+    std::mt19937_64 rng(12345);
+    std::normal_distribution<double> noise(0.0, 1e-3);
+    std::vector<Signal> signals;
+    auto add = [&](const char* name, auto sample) {
+        Signal s{name, std::vector<double>(n)};
+        for (std::size_t i = 0; i < n; i++) s.values[i] = sample(i);
+        signals.push_back(std::move(s));
+    };
+
+    add("time", [](std::size_t i) { return 1e-9 * static_cast<double>(i); });
+    add("rail", [](std::size_t) { return 3.3; });
+    add("settling", [](std::size_t i) { return 1.0 - std::exp(-1e-3 * static_cast<double>(i)); });
+    add("sine", [](std::size_t i) { return std::sin(1e-2 * static_cast<double>(i)); });
+    add("clock", [](std::size_t i) { return (i / 50) % 2 ? 3.3 : 0.0; });
+    add("noisy", [&](std::size_t) { return noise(rng); });
+    add("random_bits", [&](std::size_t) { return fromBits(rng()); });
+
+    // Bit patterns a float codec must carry unchanged: signed zeros, NaN
+    // payloads, infinities, subnormals and the extremes
+    const double special[] = {
+        0.0, -0.0, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN(), fromBits(0x7ff0000000000001ull),
+        fromBits(0xfff8dead0000beefull), std::numeric_limits<double>::denorm_min(),
+        -std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::min(),
+        std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), 1.0, 1.0,
+    };
+    add("special", [&](std::size_t i) { return special[i % (sizeof(special) / sizeof(special[0]))]; });
+    return signals;
+}
+
+// Encode and decode every prefix length up to a few hundred samples, plus
+// the whole signal; truncated segments must be rejected, not over-read
+bool checkCodec(const std::vector<Signal>& signals) {
+    bool ok = true;
+    std::vector<unsigned char> packed;
+    std::vector<double> decoded;
+    for (const Signal& s : signals) {
+        std::vector<std::size_t> lengths;
+        for (std::size_t count = 0; count <= std::min<std::size_t>(s.values.size(), 300); count++) {
+            lengths.push_back(count);
+        }
+        lengths.push_back(s.values.size());
+
+        for (std::size_t count : lengths) {
+            packed.clear();
+            WaveformCodec::encode(s.values.data(), count, packed);
+            decoded.assign(count, 0.0);
+            if (!WaveformCodec::decode(packed.data(), packed.size(), count, decoded.data()) ||
+                !sameBits(s.values.data(), decoded.data(), count)) {
+                std::printf("codec round trip failed: %s, %zu samples\n", s.name.c_str(), count);
+                ok = false;
+                break;
+            }
+            // Half a segment must fail to decode, reading only its own
+            // bytes (copied so that an over-read is caught by sanitizers)
+            std::vector<unsigned char> truncated(packed.begin(), packed.begin() + packed.size() / 2);
+            if (count > 0 && WaveformCodec::decode(truncated.data(), truncated.size(), count, decoded.data())) {
+                std::printf("truncated segment accepted: %s, %zu samples\n", s.name.c_str(), count);
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+bool checkColumns(const char* what, const std::vector<Signal>& signals, std::size_t rows,
+                  const std::vector<double>& times, const std::vector<std::vector<double>>& columns) {
+    if (times.size() != rows || !sameBits(times.data(), signals[0].values.data(), rows)) {
+        std::printf("%s round trip failed: time\n", what);
+        return false;
+    }
+    for (std::size_t s = 1; s < signals.size(); s++) {
+        if (columns[s - 1].size() != rows || !sameBits(columns[s - 1].data(), signals[s].values.data(), rows)) {
+            std::printf("%s round trip failed: %s\n", what, signals[s].name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Through a compressed store that spills most chunks, then through .spw
+// files written packed and raw
+bool checkStoreAndFiles(const std::vector<Signal>& signals) {
+    const std::size_t rows = signals[0].values.size();
+    auto spill = std::filesystem::temp_directory_path() / "waveform_codec_bench.spill";
+    auto spw = std::filesystem::temp_directory_path() / "waveform_codec_bench.spw";
+
+    WaveformStore store(256);
+    for (std::size_t s = 1; s < signals.size(); s++) store.addSignal(signals[s].name);
+    store.setCompression(true);
+    store.setMemoryBudget(64 * 1024, spill.string());
+    std::vector<double> row(signals.size() - 1);
+    for (std::size_t r = 0; r < rows; r++) {
+        for (std::size_t s = 1; s < signals.size(); s++) row[s - 1] = signals[s].values[r];
+        store.append(signals[0].values[r], row.data());
+    }
+
+    std::vector<std::vector<double>> columns;
+    for (std::size_t s = 0; s + 1 < signals.size(); s++) columns.push_back(store.signal(static_cast<int>(s)));
+    bool ok = checkColumns("store", signals, rows, store.times(), columns);
+
+    for (bool compress : {true, false}) {
+        writeWaveformFile(store, spw.string(), compress);
+        WaveformFileReader reader(spw.string());
+        std::vector<double> times(reader.size());
+        reader.copyTimes(0, times.size(), times.data());
+        for (std::size_t s = 0; s + 1 < signals.size(); s++) {
+            int signal = reader.findSignal(signals[s + 1].name);
+            columns[s].assign(reader.size(), 0.0);
+            if (signal >= 0) reader.copySignal(signal, 0, reader.size(), columns[s].data());
+        }
+        ok = checkColumns(compress ? "packed .spw" : "raw .spw", signals, rows, times, columns) && ok;
+
+        // Reads that start and end inside chunks
+        for (std::size_t first = 0; first + 300 < rows; first += 997) {
+            std::vector<double> part(300);
+            reader.copySignal(2, first, part.size(), part.data());
+            if (!sameBits(part.data(), signals[3].values.data() + first, part.size())) {
+                std::printf("%s partial read failed at row %zu\n", compress ? "packed .spw" : "raw .spw", first);
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::remove(spw, error);
+    std::filesystem::remove(spill, error);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+    n = std::max<std::size_t>(n, 1000);
+
+    std::vector<Signal> signals = makeSignals(n);
+    bool ok = checkCodec(signals);
+    ok = checkStoreAndFiles(signals) && ok;
+    std::printf("round trip: %s\n", ok ? "ok" : "FAILED");
+
+    std::vector<unsigned char> packed;
+    std::vector<double> decoded(n);
+    for (const Signal& s : signals) {
+        double encodeTime = bestSeconds(repetitions, [&] {
+            packed.clear();
+            WaveformCodec::encode(s.values.data(), n, packed);
+        });
+        double decodeTime = bestSeconds(repetitions, [&] {
+            WaveformCodec::decode(packed.data(), packed.size(), n, decoded.data());
+        });
+        std::printf("%-12s %6.2f bits/sample   encode %7.1f MB/s   decode %7.1f MB/s\n",
+                    s.name.c_str(), 8.0 * packed.size() / n, 8e-6 * n / encodeTime, 8e-6 * n / decodeTime);
+    }
+    return ok ? 0 : 1;
+}
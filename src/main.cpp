@@ -38,6 +38,7 @@
 
 #include "parser/spice_parser.h"
 #include "circuit_manager.h"
+#include "simulation_worker.h"
 
 // Forward declaration
 void drawComponent(ImDrawList* draw_list, ImVec2 canvas_offset, CircuitElement* component, CircuitElement* selected_component, float zoom, ImVec2 pan);
@@ -65,6 +66,8 @@ struct TransientSimSettings {
     char stepTimeStr[32] = "1n";
     char stopTimeStr[32] = "1u";
     char startTimeStr[32] = "0";
+    char saveStr[256] = "";         // .save signals; empty saves everything
+    char intervalStr[32] = "0";     // output interval; 0 saves every step
 };
 
 struct ACSimSettings {
@@ -137,6 +140,32 @@ double parseEngValue(const std::string& str) {
     }
 }
 
+// .save command for the probed signals and output interval, or empty
+std::string generateSaveCommand(const TransientSimSettings& settings) {
+    std::string signals = settings.saveStr;
+    bool decimated = parseEngValue(settings.intervalStr) > 0.0;
+    if (signals.find_first_not_of(" \t") == std::string::npos && !decimated) return "";
+    
+    std::string command = ".save";
+    if (signals.find_first_not_of(" \t") != std::string::npos) command += " " + signals;
+    if (decimated) command += " interval=" + std::string(settings.intervalStr);
+    return command;
+}
+
+// Adds a signal to the probe list unless it is already there
+void addProbe(TransientSimSettings& settings, const std::string& signal) {
+    std::istringstream probes(settings.saveStr);
+    std::string probe;
+    while (probes >> probe) {
+        if (probe == signal) return;
+    }
+    std::string list = settings.saveStr;
+    if (!list.empty() && list.back() != ' ') list += " ";
+    list += signal;
+    if (list.size() >= sizeof(settings.saveStr)) return;  // No room left
+    settings.saveStr[list.copy(settings.saveStr, list.size())] = '\0';
+}
+
 // Generate simulation commands based on settings
 std::string generateSimulationCommands(const SimulationConfig& config) {
     std::string commands;
@@ -156,6 +185,11 @@ std::string generateSimulationCommands(const SimulationConfig& config) {
             commands += " " + std::string(config.transient.startTimeStr);
         }
         commands += "\n";
+        
+        std::string save = generateSaveCommand(config.transient);
+        if (!save.empty()) {
+            commands += save + "\n";
+        }
     }
     
     if (config.ac.enabled) {
@@ -250,8 +284,18 @@ void ShowComponentEditDialog(CircuitElement* component, bool* show_dialog, char*
             } else {
                 ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.5f, 1.0f), "  %s: Node %d", 
                                   component->getPinName(i).c_str(), node);
+                if (node != 0) {
+                    ImGui::SameLine();
+                    std::string label = "Probe##pin" + std::to_string(i);
+                    if (ImGui::SmallButton(label.c_str())) {
+                        addProbe(simConfig.transient, "v(" + std::to_string(node) + ")");
+                    }
+                }
             }
         }
+        if (component->getType() == "vsource" && ImGui::Button("Probe Current")) {
+            addProbe(simConfig.transient, "i(" + component->name + ")");
+        }
         
         ImGui::Separator();
         
@@ -331,8 +375,16 @@ void ShowSimulationDialog(SimulationConfig& config, bool* show_dialog) {
                     ImGui::InputText("Start Time", config.transient.startTimeStr, sizeof(config.transient.startTimeStr));
                     ImGui::SameLine(); ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(optional, default 0)");
                     
+                    ImGui::Text("Saved Signals:");
+                    ImGui::InputText("Probes", config.transient.saveStr, sizeof(config.transient.saveStr));
+                    ImGui::SameLine(); ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(e.g., v(3) i(V1); empty saves all)");
+                    
+                    ImGui::InputText("Output Interval", config.transient.intervalStr, sizeof(config.transient.intervalStr));
+                    ImGui::SameLine(); ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "(optional, 0 saves every step)");
+                    
                     ImGui::Separator();
-                    ImGui::TextWrapped("Transient analysis simulates circuit behavior over time.");
+                    ImGui::TextWrapped("Transient analysis simulates circuit behavior over time. "
+                                       "Use Probe in a component's edit dialog to add its nodes.");
                     
                     // Show preview of command
                     std::string cmd = ".tran " + std::string(config.transient.stepTimeStr) + " " + 
@@ -341,6 +393,10 @@ void ShowSimulationDialog(SimulationConfig& config, bool* show_dialog) {
                         cmd += " " + std::string(config.transient.startTimeStr);
                     }
                     ImGui::Text("Command: %s", cmd.c_str());
+                    std::string save = generateSaveCommand(config.transient);
+                    if (!save.empty()) {
+                        ImGui::Text("Command: %s", save.c_str());
+                    }
                 } else {
                     ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Transient analysis disabled");
                 }
@@ -470,6 +526,9 @@ int preview_rotation = 0;
 bool show_dc_results_dialog = false;
 DCAnalysis* current_dc_analysis = nullptr;
 std::vector<std::string> dc_error_messages;
+PerfStats last_parse_stats;
+SimulationWorker simulation_worker;
+std::unique_ptr<SimulationResult> simulation_result;   // owns current_dc_analysis
 
 // Zoom and pan state
 float zoom_level = 1.0f;
@@ -508,7 +567,81 @@ ImVec2 getMouseWorldPos(ImVec2 canvas_offset, float zoom, ImVec2 pan) {
     return screenToWorld(mouse_pos, canvas_offset, zoom, pan);
 }
 
-void ShowDCResultsDialog(bool* show_dialog, DCAnalysis* dc_analysis, const CircuitManager& circuit, const std::vector<std::string>& error_messages) {
+// Progress bar, solver counters and a cancel button while the worker runs
+void ShowSimulationProgress(SimulationWorker& worker) {
+    if (!worker.busy()) return;
+    
+    const SimulationProgress& progress = worker.progress();
+    ImGui::SetNextWindowSize(ImVec2(420, 0), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("Simulation Progress")) {
+        double stop_time = progress.stopTime.load(std::memory_order_relaxed);
+        if (stop_time > 0.0) {
+            ImGui::Text("t = %.3e s / %.3e s", progress.time.load(std::memory_order_relaxed), stop_time);
+            ImGui::ProgressBar(static_cast<float>(progress.fraction()), ImVec2(-1.0f, 0.0f));
+            ImGui::Text("Time steps: %lld", progress.timeSteps.load(std::memory_order_relaxed));
+            ImGui::Text("Linearizations: %lld", progress.linearizations.load(std::memory_order_relaxed));
+            ImGui::Text("Rejected steps: %lld", progress.rejectedSteps.load(std::memory_order_relaxed));
+        } else {
+            ImGui::Text("Parsing and solving the operating point...");
+        }
+        
+        ImGui::Separator();
+        if (progress.cancelled()) {
+            ImGui::TextColored(ImVec4(0.6f, 0.6f, 0.6f, 1.0f), "Cancelling...");
+        } else if (ImGui::Button("Cancel")) {
+            worker.cancel();
+        }
+    }
+    ImGui::End();
+}
+
+// Phase timings and solver counters of a run
+void ShowPerformanceStats(const PerfStats& stats) {
+    double total = stats.totalSeconds();
+    
+    if (ImGui::BeginTable("PerformanceTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Phase", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+        ImGui::TableSetupColumn("Time (ms)", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+        ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Share", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+        
+        for (int i = 0; i < PerfStats::phaseCount; i++) {
+            PerfPhase phase = static_cast<PerfPhase>(i);
+            double seconds = stats.phaseSeconds(phase);
+            
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", perfPhaseName(phase));
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.3f", 1e3 * seconds);
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%lld", stats.phaseCalls(phase));
+            ImGui::TableSetColumnIndex(3);
+            ImGui::ProgressBar(total > 0.0 ? static_cast<float>(seconds / total) : 0.0f, ImVec2(-1.0f, 0.0f));
+        }
+        
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "TOTAL");
+        ImGui::TableSetColumnIndex(1);
+        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "%.3f", 1e3 * total);
+        
+        ImGui::EndTable();
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Solver Counters:");
+    ImGui::BulletText("Matrix Size: %dx%d", stats.matrixSize, stats.matrixSize);
+    ImGui::BulletText("Matrix Nonzeros: %lld", stats.matrixNonZeros);
+    ImGui::BulletText("Factor Nonzeros: %lld (fill-in %lld)", stats.factorNonZeros, stats.fillIn);
+    ImGui::BulletText("Factorizations: %lld", stats.factorizations);
+    ImGui::BulletText("Time Steps: %lld", stats.timeSteps);
+    ImGui::BulletText("Linearizations: %lld", stats.linearizations);
+    ImGui::BulletText("Rejected Steps: %lld", stats.rejectedSteps);
+}
+
+void ShowDCResultsDialog(bool* show_dialog, DCAnalysis* dc_analysis, const CircuitManager& circuit, const std::vector<std::string>& error_messages, const PerfStats& parse_stats) {
     if (!*show_dialog) return;
     
     ImGui::SetNextWindowSize(ImVec2(600, 500), ImGuiCond_FirstUseEver);
@@ -832,6 +965,18 @@ void ShowDCResultsDialog(bool* show_dialog, DCAnalysis* dc_analysis, const Circu
                     ImGui::EndTabItem();
                 }
                 
+                // Performance Tab
+                if (ImGui::BeginTabItem("Performance")) {
+                    ImGui::Text("Run Performance");
+                    ImGui::Separator();
+                    
+                    PerfStats run_stats = parse_stats;
+                    run_stats.merge(dc_analysis->getStats());
+                    ShowPerformanceStats(run_stats);
+                    
+                    ImGui::EndTabItem();
+                }
+                
                 ImGui::EndTabBar();
             }
             
@@ -900,7 +1045,6 @@ int main() {
     int wire_start_pin = -1;
     ImVec2 wire_start_pos;
     ImVec2 current_mouse_pos;
-    SPICEParser parser;
     std::vector<WireSegment> current_wire_segments;
     bool wire_horizontal_first = true;
     ImVec2 last_wire_point;
@@ -941,7 +1085,7 @@ int main() {
                 if (ImGui::MenuItem("Simulation Settings")) {
                     show_simulation_dialog = true;
                 }
-                ImGui::MenuItem("Simulate", "Ctrl+Enter", &simulate);
+                ImGui::MenuItem("Simulate", "Ctrl+Enter", &simulate, !simulation_worker.busy());
                 ImGui::EndMenu();
             }
             ImGui::EndMainMenuBar();
@@ -1616,17 +1760,23 @@ int main() {
        }
 
        // Show DC results dialog
-       ShowDCResultsDialog(&show_dc_results_dialog, current_dc_analysis, circuit, dc_error_messages);
+       ShowDCResultsDialog(&show_dc_results_dialog, current_dc_analysis, circuit, dc_error_messages, last_parse_stats);
 
-       // Handle simulation
+       // Show progress of a running simulation
+       ShowSimulationProgress(simulation_worker);
+
+       // Handle simulation: parsing and the analyses run on the worker
+       // thread, so the window keeps rendering while they do
        if(simulate){
-           // Run and show simulation results
-           std::cout << "Starting simulation..." << std::endl;
-           
-           try {
+           if (simulation_worker.busy()) {
+               std::cout << "A simulation is already running." << std::endl;
+           } else {
+               std::cout << "Starting simulation..." << std::endl;
+               
                // Clear previous results
                dc_error_messages.clear();
                current_dc_analysis = nullptr;
+               simulation_result.reset();
                
                // Validate circuit first
                auto validation_errors = circuit.validateCircuit();
@@ -1638,63 +1788,74 @@ int main() {
                    }
                }
                
-               // Generate netlist with current simulation settings
-               std::string netlist_with_sim = generateNetlistWithSettings(circuit, simConfig);
-               current_netlist = netlist_with_sim;
-               
-               // Create a temporary netlist file
-               std::ofstream temp_file("temp_circuit.cir");
-               temp_file << netlist_with_sim;
-               temp_file.close();
-               
-               // Parse the circuit
-               parser.parseFile("temp_circuit.cir");
-               parser.printParsedElements();
-               
-               // Run DC analysis if enabled
-               if (simConfig.dc.enabled) {
-                   std::cout << "Running DC analysis..." << std::endl;
-                   
-                   // Create a new DC analysis instance
-                   static DCAnalysis dc_analysis_instance(const_cast<std::vector<std::unique_ptr<CircuitElement>>&>(parser.getElements()), parser.getNumNodes());
-                   current_dc_analysis = &dc_analysis_instance;
-                   
-                   // Run the analysis
-                   current_dc_analysis->solve();
-                   
-                   // Show results dialog
-                   show_dc_results_dialog = true;
-               }
-               
-               // Run other analysis types based on settings
+               // Hand the schematic to the simulator directly; the copy is
+               // taken here, so editing during the run is safe
+               auto compiled = std::make_unique<SPICEParser>();
+               compiled->loadCircuit(circuit.getComponents());
+               compiled->setDCAnalysis(simConfig.dc.enabled);
                if (simConfig.transient.enabled) {
-                   std::cout << "Transient analysis would run here..." << std::endl;
-                   // TODO: Implement transient analysis results dialog
-               }
-               
-               if (simConfig.ac.enabled) {
-                   std::cout << "AC analysis would run here..." << std::endl;
-                   // TODO: Implement AC analysis results dialog
-               }
-               
-               if (simConfig.dcSweep.enabled) {
-                   std::cout << "DC sweep analysis would run here..." << std::endl;
-                   // TODO: Implement DC sweep results dialog
+                   compiled->setTransientSettings(TransientSettings(
+                       compiled->parseValue(simConfig.transient.stepTimeStr),
+                       compiled->parseValue(simConfig.transient.stopTimeStr),
+                       compiled->parseValue(simConfig.transient.startTimeStr)));
+                   
+                   std::istringstream probes(simConfig.transient.saveStr);
+                   std::string probe;
+                   while (probes >> probe) {
+                       compiled->addSave(probe);
+                   }
+                   compiled->setSaveInterval(compiled->parseValue(simConfig.transient.intervalStr));
                }
                
-               std::cout << "Simulation completed successfully!" << std::endl;
-               
-               // Clean up temporary file
-               std::remove("temp_circuit.cir");
-               
-           } catch (const std::exception& e) {
-               std::cerr << "Simulation error: " << e.what() << std::endl;
-               dc_error_messages.push_back("Simulation error: " + std::string(e.what()));
-               show_dc_results_dialog = true; // Show dialog with error
+               simulation_worker.start(std::move(compiled), simConfig.dc.enabled, "transient_results.csv");
            }
            simulate = false;
        }
 
+       // Pick up a finished run; the result object is moved, not copied
+       if (std::unique_ptr<SimulationResult> result = simulation_worker.takeResult()) {
+           simulation_result = std::move(result);
+           if (simulation_result->parser) {
+               last_parse_stats = simulation_result->parser->getStats();
+               simulation_result->parser->printParsedElements();
+           }
+           
+           for (const auto& error : simulation_result->errors) {
+               dc_error_messages.push_back(error);
+           }
+           
+           if (simulation_result->dc) {
+               current_dc_analysis = simulation_result->dc.get();
+               show_dc_results_dialog = true;
+           }
+           if (!simulation_result->errors.empty()) {
+               show_dc_results_dialog = true; // Show dialog with error
+           }
+           
+           // Run other analysis types based on settings
+           if (simulation_result->transient) {
+               std::cout << "Transient analysis: " << simulation_result->transient->getWaveforms().size()
+                         << " time points" << std::endl;
+               // TODO: Implement transient analysis results dialog
+           }
+           
+           if (simConfig.ac.enabled) {
+               std::cout << "AC analysis would run here..." << std::endl;
+               // TODO: Implement AC analysis results dialog
+           }
+           
+           if (simConfig.dcSweep.enabled) {
+               std::cout << "DC sweep analysis would run here..." << std::endl;
+               // TODO: Implement DC sweep results dialog
+           }
+           
+           if (simulation_result->cancelled) {
+               std::cout << "Simulation cancelled." << std::endl;
+           } else {
+               std::cout << "Simulation completed successfully!" << std::endl;
+           }
+       }
+
        // Rendering
        ImGui::Render();
        int display_w, display_h;
@@ -240,7 +240,7 @@ public:
     
     std::string getType() const override { return "ground"; }
     std::string getValue() const override { return "GND"; }
-    void setValue(const std::string& value) override { }
+    void setValue(const std::string&) override { }
     
     std::string toSpiceLine() const override {
         return "";  // Ground doesn't generate SPICE line
@@ -250,7 +250,7 @@ public:
         return true;  // Ground is always connected
     }
     
-    void setNodeForPin(int pin_index, int node_id) {
+    void setNodeForPin(int pin_index, int /*node_id*/) {
         // When something connects to ground, force the other component's node to 0
         if (pin_index == 0) {
             pins[0].node_id = 0;  // Ground pin stays at 0
@@ -351,20 +351,30 @@ public:
         return name + " " + std::to_string(pins[0].node_id) + " " + std::to_string(pins[1].node_id) + " " + model;
     }
     
-    // Diode I-V relationship: I = Is * (exp(V/(n*Vt)) - 1)
-    double getCurrent(double voltage) const {
+    // Current and conductance at one bias point
+    struct OperatingPoint {
+        double current;      // I
+        double conductance;  // dI/dV
+    };
+    
+    // Diode I-V relationship: I = Is * (exp(V/(n*Vt)) - 1), evaluated with a
+    // single exp for both the current and its derivative
+    OperatingPoint evaluate(double voltage) const {
         if (voltage < -5.0 * n * Vt) {
-            return -Is;  // Reverse saturation
+            // Reverse saturation, very small conductance
+            return {-Is, 1e-12};
         }
-        return Is * (std::exp(voltage / (n * Vt)) - 1.0);
+        double e = std::exp(voltage / (n * Vt));
+        return {Is * (e - 1.0), (Is / (n * Vt)) * e};
+    }
+    
+    double getCurrent(double voltage) const {
+        return evaluate(voltage).current;
     }
     
     // Conductance = dI/dV
     double getConductance(double voltage) const {
-        if (voltage < -5.0 * n * Vt) {
-            return 1e-12;  // Very small conductance in reverse
-        }
-        return (Is / (n * Vt)) * std::exp(voltage / (n * Vt));
+        return evaluate(voltage).conductance;
     }
 };
 
@@ -406,50 +416,55 @@ public:
         return Region::SATURATION;
     }
     
-    // Drain current calculation
-    double getDrainCurrent(double Vgs, double Vds) const {
-        if (Vgs < Vth) return 0.0;  // Cutoff
+    // Drain current and its partial derivatives at one bias point
+    struct OperatingPoint {
+        double id;   // Drain current
+        double gm;   // dId/dVgs
+        double gds;  // dId/dVds
+        Region region;
+    };
+    
+    // Fused evaluation: one region classification and one beta product for
+    // the current and all derivatives
+    OperatingPoint evaluate(double Vgs, double Vds) const {
+        if (Vgs < Vth) {
+            // Cutoff, very small leakage
+            return {0.0, 0.0, 1e-12, Region::CUTOFF};
+        }
         
         double beta = Kn * (W / L);
+        double vov = Vgs - Vth;
+        double clm = 1 + lambda * Vds;
         
-        if (Vds < (Vgs - Vth)) {
+        if (Vds < vov) {
             // Triode/Linear region
-            return beta * ((Vgs - Vth) * Vds - 0.5 * Vds * Vds) * (1 + lambda * Vds);
-        } else {
-            // Saturation region
-            return 0.5 * beta * (Vgs - Vth) * (Vgs - Vth) * (1 + lambda * Vds);
+            double core = vov * Vds - 0.5 * Vds * Vds;
+            return {beta * core * clm,
+                    beta * Vds * clm,
+                    beta * (vov - Vds) * clm + beta * core * lambda,
+                    Region::TRIODE};
         }
+        
+        // Saturation region
+        return {0.5 * beta * vov * vov * clm,
+                beta * vov * clm,
+                0.5 * beta * lambda * vov * vov,
+                Region::SATURATION};
+    }
+    
+    // Drain current calculation
+    double getDrainCurrent(double Vgs, double Vds) const {
+        return evaluate(Vgs, Vds).id;
     }
     
     // Transconductance gm = dId/dVgs
     double getTransconductance(double Vgs, double Vds) const {
-        if (Vgs < Vth) return 0.0;
-        
-        double beta = Kn * (W / L);
-        
-        if (Vds < (Vgs - Vth)) {
-            // Triode region
-            return beta * Vds * (1 + lambda * Vds);
-        } else {
-            // Saturation region
-            return beta * (Vgs - Vth) * (1 + lambda * Vds);
-        }
+        return evaluate(Vgs, Vds).gm;
     }
     
     // Output conductance gds = dId/dVds
     double getOutputConductance(double Vgs, double Vds) const {
-        if (Vgs < Vth) return 1e-12;  // Very small leakage
-        
-        double beta = Kn * (W / L);
-        
-        if (Vds < (Vgs - Vth)) {
-            // Triode region
-            return beta * (Vgs - Vth - Vds) * (1 + lambda * Vds) + 
-                   beta * ((Vgs - Vth) * Vds - 0.5 * Vds * Vds) * lambda;
-        } else {
-            // Saturation region
-            return 0.5 * beta * lambda * (Vgs - Vth) * (Vgs - Vth);
-        }
+        return evaluate(Vgs, Vds).gds;
     }
 };
 
@@ -482,19 +497,48 @@ public:
                std::to_string(pins[3].node_id) + " " + model;
     }
     
-    // For PMOS, all voltages are typically referenced with opposite polarity
-    double getDrainCurrent(double Vsg, double Vsd) const {  // Note: source-gate, source-drain
-        if (Vsg < -Vth) return 0.0;  // Cutoff (Vth is negative)
+    enum class Region { CUTOFF, TRIODE, SATURATION };
+    
+    // Source-referenced drain current (flowing source to drain) and its
+    // partial derivatives at one bias point
+    struct OperatingPoint {
+        double id;   // Source-to-drain current
+        double gm;   // dId/dVsg
+        double gds;  // dId/dVsd
+        Region region;
+    };
+    
+    // For PMOS, all voltages are typically referenced with opposite polarity:
+    // Vsg = Vs - Vg, Vsd = Vs - Vd. Vth is negative, so Vsg + Vth is the
+    // overdrive Vsg - |Vth|.
+    OperatingPoint evaluate(double Vsg, double Vsd) const {
+        if (Vsg < -Vth) {
+            // Cutoff, very small leakage
+            return {0.0, 0.0, 1e-12, Region::CUTOFF};
+        }
         
         double beta = Kp * (W / L);
+        double vov = Vsg + Vth;
+        double clm = 1 + lambda * Vsd;
         
-        if (Vsd < (Vsg + Vth)) {  // Vth is negative, so this is (Vsg - |Vth|)
+        if (Vsd < vov) {
             // Triode region
-            return beta * ((Vsg + Vth) * Vsd - 0.5 * Vsd * Vsd) * (1 + lambda * Vsd);
-        } else {
-            // Saturation region
-            return 0.5 * beta * (Vsg + Vth) * (Vsg + Vth) * (1 + lambda * Vsd);
+            double core = vov * Vsd - 0.5 * Vsd * Vsd;
+            return {beta * core * clm,
+                    beta * Vsd * clm,
+                    beta * (vov - Vsd) * clm + beta * core * lambda,
+                    Region::TRIODE};
         }
+        
+        // Saturation region
+        return {0.5 * beta * vov * vov * clm,
+                beta * vov * clm,
+                0.5 * beta * lambda * vov * vov,
+                Region::SATURATION};
+    }
+    
+    double getDrainCurrent(double Vsg, double Vsd) const {  // Note: source-gate, source-drain
+        return evaluate(Vsg, Vsd).id;
     }
 };
 
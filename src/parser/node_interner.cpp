@@ -0,0 +1,114 @@
+#include "node_interner.h"
+
+namespace {
+
+inline unsigned char lowerAscii(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return (u >= 'A' && u <= 'Z') ? static_cast<unsigned char>(u | 0x20) : u;
+}
+
+} // namespace
+
+// FNV-1a over the lower-cased bytes
+std::uint64_t NodeInterner::hashName(std::string_view name) {
+    std::uint64_t hash = 1469598103934665603ull;
+    for (char c : name) {
+        hash ^= lowerAscii(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool NodeInterner::sameName(std::string_view name, const Slot& slot) {
+    if (name.size() != slot.length) return false;
+    for (std::size_t i = 0; i < name.size(); i++) {
+        if (lowerAscii(name[i]) != static_cast<unsigned char>(slot.key[i])) return false;
+    }
+    return true;
+}
+
+const char* NodeInterner::store(std::string_view name) {
+    if (name.size() > arenaLeft) {
+        // Names longer than a block get a block of their own
+        std::size_t blockSize = name.size() > arenaBlockSize ? name.size() : arenaBlockSize;
+        blocks.emplace_back(new char[blockSize]);
+        arenaPos = blocks.back().get();
+        arenaLeft = blockSize;
+    }
+    char* key = arenaPos;
+    for (std::size_t i = 0; i < name.size(); i++) {
+        key[i] = static_cast<char>(lowerAscii(name[i]));
+    }
+    arenaPos += name.size();
+    arenaLeft -= name.size();
+    return key;
+}
+
+std::size_t NodeInterner::findSlot(std::string_view name, std::uint64_t hash) const {
+    std::size_t mask = slots.size() - 1;
+    std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32);
+    for (std::size_t i = static_cast<std::size_t>(hash) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.id < 0 || (slot.hash == tag && sameName(name, slot))) return i;
+    }
+}
+
+void NodeInterner::grow() {
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.resize(old.empty() ? 64 : old.size() * 2);
+    std::size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id < 0) continue;
+        std::size_t i = static_cast<std::size_t>(hashName(std::string_view(slot.key, slot.length))) & mask;
+        while (slots[i].id >= 0) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+int NodeInterner::insert(std::string_view name, int id) {
+    // Keep the load factor at or below 3/4
+    if ((used + 1) * 4 > slots.size() * 3) grow();
+
+    std::uint64_t hash = hashName(name);
+    Slot& slot = slots[findSlot(name, hash)];
+    if (slot.id >= 0) return slot.id;
+
+    slot.key = store(name);
+    slot.length = static_cast<std::uint32_t>(name.size());
+    slot.hash = static_cast<std::uint32_t>(hash >> 32);
+    if (id < 0) {
+        id = static_cast<int>(names.size());
+        names.emplace_back(slot.key, name.size());
+    }
+    slot.id = id;
+    used++;
+    return id;
+}
+
+int NodeInterner::intern(std::string_view name) {
+    return insert(name, -1);
+}
+
+void NodeInterner::addAlias(std::string_view name, int id) {
+    insert(name, id);
+}
+
+int NodeInterner::find(std::string_view name) const {
+    if (slots.empty()) return -1;
+    return slots[findSlot(name, hashName(name))].id;
+}
+
+void NodeInterner::reserve(std::size_t count) {
+    names.reserve(count);
+    while (count * 4 > slots.size() * 3) grow();
+}
+
+void NodeInterner::clear() {
+    slots.clear();
+    used = 0;
+    names.clear();
+    blocks.clear();
+    arenaPos = nullptr;
+    arenaLeft = 0;
+}
@@ -0,0 +1,65 @@
+#ifndef NODE_INTERNER_H
+#define NODE_INTERNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Case-insensitive node name table handing out dense ids 0, 1, 2, ... in
+// order of first appearance. Lookups hash and compare the caller's text in
+// place (no lower-cased copy); new names are stored once, lower-cased, in a
+// bump arena, so the views returned by name() stay valid for the life of
+// the interner. Open addressing with linear probing keeps a lookup to one
+// or two cache lines.
+class NodeInterner {
+private:
+    struct Slot {
+        const char* key = nullptr;   // lower-cased name in the arena
+        std::uint32_t length = 0;
+        std::uint32_t hash = 0;      // high bits of the 64-bit hash
+        std::int32_t id = -1;        // -1: empty
+    };
+
+    static constexpr std::size_t arenaBlockSize = 64 * 1024;
+
+    std::vector<Slot> slots;
+    std::size_t used = 0;                 // occupied slots, aliases included
+    std::vector<std::string_view> names;  // by id
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* arenaPos = nullptr;
+    std::size_t arenaLeft = 0;
+
+    static std::uint64_t hashName(std::string_view name);
+    static bool sameName(std::string_view name, const Slot& slot);
+    const char* store(std::string_view name);
+    std::size_t findSlot(std::string_view name, std::uint64_t hash) const;
+    void grow();
+    int insert(std::string_view name, int id);
+
+public:
+    NodeInterner() = default;
+    NodeInterner(NodeInterner&&) = default;
+    NodeInterner& operator=(NodeInterner&&) = default;
+    NodeInterner(const NodeInterner&) = delete;
+    NodeInterner& operator=(const NodeInterner&) = delete;
+
+    // Id of name, assigning the next one if it is new
+    int intern(std::string_view name);
+
+    // Id of name, or -1
+    int find(std::string_view name) const;
+
+    // Makes name another spelling of an existing id (e.g. gnd for 0)
+    void addAlias(std::string_view name, int id);
+
+    // Lower-cased name an id was first interned under
+    std::string_view name(int id) const { return names[id]; }
+
+    std::size_t size() const { return names.size(); }
+    void reserve(std::size_t count);
+    void clear();
+};
+
+#endif
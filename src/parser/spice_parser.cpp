@@ -1,109 +1,359 @@
 #include "spice_parser.h"
-std::vector<std::string> SPICETokenizer::tokenizeLine(const std::string& line){
-    std::vector<std::string> tokens;
-    std::string cleanLine = line;
+#include <charconv>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include "util/log.h"
 
-    size_t commentPos = cleanLine.find(';');
-    if (commentPos != std::string::npos) {
-        cleanLine = cleanLine.substr(0, commentPos);
-    }
+namespace {
 
-    if (!cleanLine.empty() && cleanLine[0] == '*') {
-        return tokens; // Return empty vector for comment lines
-    }
+// Parses the leading number of [first, last) into value and returns where
+// it stopped, or null if there is no number
+const char* parseNumber(const char* first, const char* last, double& value) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+    // Standard libraries without floating-point from_chars
+    char text[64];
+    std::size_t length = std::min<std::size_t>(last - first, sizeof(text) - 1);
+    std::memcpy(text, first, length);
+    text[length] = '\0';
+    char* stop = nullptr;
+    value = std::strtod(text, &stop);
+    return stop == text ? nullptr : first + (stop - text);
+#endif
+}
 
-    cleanLine.erase(0, cleanLine.find_first_not_of(" \t\r\n"));
-    cleanLine.erase(cleanLine.find_last_not_of(" \t\r\n") + 1);
-    
-    if (cleanLine.empty()) {
-        return tokens;
+// Scale of an engineering suffix; anything else (units) scales by 1
+double engineeringMultiplier(std::string_view suffix) {
+    if (suffix.empty()) return 1.0;
+    switch (std::tolower(static_cast<unsigned char>(suffix[0]))) {
+        case 't': return 1e12;
+        case 'g': return 1e9;
+        case 'k': return 1e3;
+        case 'm':
+            // Could be 'meg' (1e6) or 'm' (1e-3)
+            if (suffix.size() >= 3 && std::tolower(static_cast<unsigned char>(suffix[1])) == 'e' &&
+                std::tolower(static_cast<unsigned char>(suffix[2])) == 'g') {
+                return 1e6;
+            }
+            return 1e-3;
+        case 'u': return 1e-6;
+        case 'n': return 1e-9;
+        case 'p': return 1e-12;
+        case 'f': return 1e-15;
+        default: return 1.0;
     }
+}
 
-    std::istringstream iss(cleanLine);
-    std::string token;
-    while (iss >> token) {
-        tokens.push_back(token);
+// Pieces smaller than this are not worth a thread
+constexpr size_t minParseChunkBytes = size_t(1) << 20;
+
+// Start of the first statement at or after offset: past the end of the
+// line containing offset-1, and past any '+' continuation lines
+size_t statementBoundary(std::string_view text, size_t offset) {
+    if (offset == 0) return 0;
+    while (offset < text.size()) {
+        size_t newline = text.find('\n', offset - 1);
+        if (newline == std::string_view::npos) return text.size();
+        offset = newline + 1;
+        if (offset >= text.size() || text[offset] != '+') return offset;
+        offset++;
     }
-    
-    return tokens;
+    return text.size();
 }
 
-bool SPICETokenizer::hasMoreLines() {
-    return current_line < lines.size();
-}
+} // namespace
 
-std::string SPICETokenizer::getNextLine() {
-    if (hasMoreLines()) {
-        return lines[current_line++];
-    }
-    return "";
+std::string_view SPICETokenizer::takeLine() {
+    const char* begin = pos;
+    const char* newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+    const char* lineEnd = newline ? newline : end;
+    pos = newline ? newline + 1 : end;
+    return std::string_view(begin, lineEnd - begin);
 }
 
-void SPICETokenizer::loadFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filename);
+void SPICETokenizer::splitLine(std::string_view line, SPICETokens& tokens) {
+    size_t commentPos = line.find(';');
+    if (commentPos != std::string_view::npos) {
+        line = line.substr(0, commentPos);
     }
     
-    lines.clear();
-    current_line = 0;
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        // Handle line continuation (lines starting with '+')
-        if (!line.empty() && line[0] == '+' && !lines.empty()) {
-            // Append to previous line (remove the '+')
-            lines.back() += " " + line.substr(1);
-        } else {
-            lines.push_back(line);
+    auto isSpace = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    };
+    const char* p = line.data();
+    const char* lineEnd = p + line.size();
+    while (p < lineEnd) {
+        while (p < lineEnd && isSpace(*p)) ++p;
+        const char* tokenBegin = p;
+        while (p < lineEnd && !isSpace(*p)) ++p;
+        if (p > tokenBegin) {
+            tokens.emplace_back(tokenBegin, p - tokenBegin);
         }
     }
+}
+
+bool SPICETokenizer::next(SPICETokens& tokens) {
+    tokens.clear();
+    while (pos < end) {
+        std::string_view line = takeLine();
+        bool comment = !line.empty() && line[0] == '*';
+        if (!comment) {
+            splitLine(line, tokens);
+        }
+        
+        // Handle line continuation (lines starting with '+'); those after a
+        // comment line belong to the comment
+        while (pos < end && *pos == '+') {
+            std::string_view continuation = takeLine().substr(1);
+            if (!comment) {
+                splitLine(continuation, tokens);
+            }
+        }
+        
+        if (!tokens.empty()) return true;
+    }
+    return false;
+}
+
+void SPICETokenizer::loadFile(const std::string& filename) {
+    file.open(filename);
+    file.adviseSequential();
+    buffer.clear();
+    pos = file.data();
+    end = pos + file.size();
+}
+
+void SPICETokenizer::loadStream(std::istream& input) {
     file.close();
+    buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    pos = buffer.data();
+    end = pos + buffer.size();
 }
 
-void SPICEParser::parseFile(const std::string& filename) {
+void SPICETokenizer::loadString(std::string_view text) {
+    file.close();
+    buffer.clear();
+    pos = text.data();
+    end = pos + text.size();
+}
+
+void SPICEParser::reset() {
     elements.clear();
-    nodeMap.clear();
+    nodes.clear();
+    stats.reset();
+    delete transientSettings;
+    transientSettings = nullptr;
+    dcRequested = false;
+    saveNodes.clear();
+    saveCurrents.clear();
+    saveAll = false;
+    saveInterval = 0.0;
+    
+    // Initialize ground node (node 0)
+    nodes.intern("0");
+    nodes.addAlias("gnd", 0);
+    nodes.addAlias("ground", 0);
+}
+
+void SPICEParser::parseFile(const std::string& filename) {
+    reset();
+    ScopedPhaseTimer timer(stats, PerfPhase::Parse);
     
     SPICETokenizer tokenizer;
     tokenizer.loadFile(filename);
+    parseLines(tokenizer, timer);
+}
+
+void SPICEParser::parseStream(std::istream& input) {
+    reset();
+    ScopedPhaseTimer timer(stats, PerfPhase::Parse);
     
-    // Initialize ground node (node 0)
-    nodeMap["0"] = 0;
-    nodeMap["gnd"] = 0;
-    nodeMap["ground"] = 0;
-    numNodes = 1; // Start with 1 because we have ground
-    
-    while (tokenizer.hasMoreLines()) {
-        std::string line = tokenizer.getNextLine();
-        auto tokens = tokenizer.tokenizeLine(line);
-        
-        if (tokens.empty()) continue;
-        
+    SPICETokenizer tokenizer;
+    tokenizer.loadStream(input);
+    parseLines(tokenizer, timer);
+}
+
+void SPICEParser::parseString(const std::string& netlist) {
+    reset();
+    ScopedPhaseTimer timer(stats, PerfPhase::Parse);
+    
+    SPICETokenizer tokenizer;
+    tokenizer.loadString(netlist);
+    parseLines(tokenizer, timer);
+}
+
+void SPICEParser::parseLines(SPICETokenizer& tokenizer, ScopedPhaseTimer& timer) {
+    std::string_view text = tokenizer.remaining();
+    size_t threads = parseThreads > 0 ? parseThreads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, text.size() / minParseChunkBytes);
+    if (threads > 1) {
+        parseChunks(text, static_cast<int>(threads), timer);
+        return;
+    }
+    
+    SPICETokens tokens;
+    while (tokenizer.next(tokens)) {
         // Check if it's a command (starts with '.')
         if (tokens[0][0] == '.') {
+            timer.stop();
             parseCommand(tokens);
+            timer.restart();
         } else {
             parseComponent(tokens);
         }
     }
     
-    std::cout << "Parsed " << elements.size() << " components with " 
-              << numNodes << " unique nodes." << std::endl;
+    SPICE_LOG_INFO(Parser, "Parsed " << elements.size() << " components with " 
+                           << nodes.size() << " unique nodes.");
+}
+
+void SPICEParser::parseChunks(std::string_view text, int threads, ScopedPhaseTimer& timer) {
+    // Each piece gets its own parser, numbering the nodes it meets from 1
+    // in order of appearance. Renumbering the pieces through this parser
+    // in file order then reproduces the serial numbering exactly, which a
+    // table shared between threads (ids in arrival order) would not.
+    struct Chunk {
+        std::string_view text;
+        SPICEParser parser;
+        std::vector<SPICETokens> commands;
+        std::exception_ptr error;
+    };
+    std::vector<Chunk> chunks(threads);
+    size_t begin = 0;
+    for (int i = 0; i < threads; i++) {
+        size_t end = i + 1 == threads ? text.size()
+                                      : statementBoundary(text, text.size() * (i + 1) / threads);
+        end = std::max(end, begin);
+        chunks[i].text = text.substr(begin, end - begin);
+        begin = end;
+    }
+    
+    auto parseChunk = [](Chunk& chunk) {
+        try {
+            chunk.parser.reset();
+            SPICETokenizer tokenizer;
+            tokenizer.loadString(chunk.text);
+            SPICETokens tokens;
+            while (tokenizer.next(tokens)) {
+                if (tokens[0][0] == '.') {
+                    chunk.commands.push_back(tokens);
+                } else {
+                    chunk.parser.parseComponent(tokens);
+                }
+            }
+        } catch (...) {
+            chunk.error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(parseChunk, std::ref(chunks[i]));
+    }
+    parseChunk(chunks[0]);
+    for (auto& worker : workers) worker.join();
+    
+    size_t total = 0;
+    for (const auto& chunk : chunks) {
+        if (chunk.error) std::rethrow_exception(chunk.error);
+        total += chunk.parser.elements.size();
+    }
+    elements.reserve(total);
+    
+    std::vector<int> remap;
+    for (auto& chunk : chunks) {
+        SPICEParser& piece = chunk.parser;
+        remap.assign(piece.nodes.size(), 0);
+        for (size_t id = 1; id < piece.nodes.size(); id++) {
+            remap[id] = nodes.intern(piece.nodes.name(static_cast<int>(id)));
+        }
+        
+        for (auto& element : piece.elements) {
+            for (auto& pin : element->pins) {
+                pin.node_id = remap[pin.node_id];
+            }
+            elements.push_back(std::move(element));
+        }
+        piece.elements.clear();
+    }
+    
+    for (const auto& chunk : chunks) {
+        for (const auto& command : chunk.commands) {
+            timer.stop();
+            parseCommand(command);
+            timer.restart();
+        }
+    }
+    
+    SPICE_LOG_INFO(Parser, "Parsed " << elements.size() << " components with " 
+                           << nodes.size() << " unique nodes on " << threads << " threads.");
+}
+
+void SPICEParser::loadCircuit(const std::vector<std::unique_ptr<CircuitElement>>& components) {
+    reset();
+    ScopedPhaseTimer timer(stats, PerfPhase::Parse);
+    
+    for (const auto& component : components) {
+        if (component->getType() == "ground") continue;  // Ground symbols only name node 0
+        if (!component->isFullyConnected()) {
+            SPICE_LOG_DEBUG(Parser, component->name << " not fully connected, skipped");
+            continue;
+        }
+        
+        std::unique_ptr<CircuitElement> element;
+        const CircuitElement* c = component.get();
+        if (auto* r = dynamic_cast<const Resistor*>(c)) {
+            element = std::make_unique<Resistor>(*r);
+        } else if (auto* cap = dynamic_cast<const Capacitor*>(c)) {
+            element = std::make_unique<Capacitor>(*cap);
+        } else if (auto* v = dynamic_cast<const VoltageSource*>(c)) {
+            element = std::make_unique<VoltageSource>(*v);
+        } else if (auto* l = dynamic_cast<const Inductor*>(c)) {
+            element = std::make_unique<Inductor>(*l);
+        } else if (auto* d = dynamic_cast<const Diode*>(c)) {
+            element = std::make_unique<Diode>(*d);
+        } else if (auto* nmos = dynamic_cast<const NMOSFET*>(c)) {
+            element = std::make_unique<NMOSFET>(*nmos);
+        } else if (auto* pmos = dynamic_cast<const PMOSFET*>(c)) {
+            element = std::make_unique<PMOSFET>(*pmos);
+        } else {
+            SPICE_LOG_WARN(Parser, "Unknown component type: " << c->getType() 
+                                   << " in " << c->name);
+            continue;
+        }
+        
+        // Schematic node ids are sparse; number them as the netlist would
+        for (int pin = 0; pin < element->getPinCount(); pin++) {
+            element->setNodeForPin(pin, getNodeNumber(std::to_string(element->getNodeForPin(pin))));
+        }
+        elements.push_back(std::move(element));
+    }
+    
+    SPICE_LOG_INFO(Parser, "Loaded " << elements.size() << " components with " 
+                           << nodes.size() << " unique nodes.");
+}
+
+void SPICEParser::setTransientSettings(const TransientSettings& settings) {
+    delete transientSettings;
+    transientSettings = new TransientSettings(settings);
 }
 
-void SPICEParser::parseCommand(const std::vector<std::string>& tokens) {
-    std::string command = tokens[0];
+void SPICEParser::parseCommand(const SPICETokens& tokens) {
+    std::string command(tokens[0]);
     std::transform(command.begin(), command.end(), command.begin(), ::tolower);
     
     if (command == ".end") {
-        std::cout << "End of netlist reached." << std::endl;
+        SPICE_LOG_DEBUG(Parser, "End of netlist reached.");
     } else if (command == ".tran") {
         if (tokens.size() >= 3) {
-            std::cout << "Transient analysis: step=" << tokens[1] 
-                        << ", stop=" << tokens[2] << std::endl;
+            SPICE_LOG_DEBUG(Parser, "Transient analysis: step=" << tokens[1] 
+                                    << ", stop=" << tokens[2]);
         }else{
-            std::cerr << "Invalid .tran command. Usage: .tran <step> <stop> [start]" << std::endl;
+            SPICE_LOG_ERROR(Parser, "Invalid .tran command. Usage: .tran <step> <stop> [start]");
             return;
         }
 
@@ -115,8 +365,8 @@ void SPICEParser::parseCommand(const std::vector<std::string>& tokens) {
             startTime = parseValue(tokens[3]);
         }
         
-        std::cout << "Transient analysis: step=" << stepTime 
-                << "s, stop=" << stopTime << "s, start=" << startTime << "s" << std::endl;
+        SPICE_LOG_INFO(Parser, "Transient analysis: step=" << stepTime 
+                               << "s, stop=" << stopTime << "s, start=" << startTime << "s");
         
         // Store transient settings
         if (transientSettings) {
@@ -125,60 +375,103 @@ void SPICEParser::parseCommand(const std::vector<std::string>& tokens) {
         this->transientSettings = new TransientSettings(stepTime, stopTime, startTime);
 
         if (!transientSettings) {
-            std::cout << "No transient analysis specified (.tran command required)" << std::endl;
+            SPICE_LOG_WARN(Parser, "No transient analysis specified (.tran command required)");
             return;
         }
+        if (!runAnalyses) return;
         
-        std::cout << "\n=== Starting Transient Analysis ===" << std::endl;
+        SPICE_LOG_INFO(Parser, "=== Starting Transient Analysis ===");
         
         if (elements.empty()) {
-            std::cout << "No circuit elements found. Cannot run transient analysis." << std::endl;
+            SPICE_LOG_WARN(Parser, "No circuit elements found. Cannot run transient analysis.");
             return;
         }
         
-        TransientAnalysis transientAnalysis(elements, numNodes, *transientSettings);
+        TransientAnalysis transientAnalysis(elements, getNumNodes(), *transientSettings);
+        transientAnalysis.setSaveSettings(getSaveSettings());
         transientAnalysis.solve();
         transientAnalysis.exportResults("transient_results.csv");
     } else if (command == ".dc" || command==".op") {
-        std::cout << "DC analysis specified" << std::endl;
+        SPICE_LOG_INFO(Parser, "DC analysis specified");
+        dcRequested = true;
+        if (!runAnalyses) return;
         if (elements.empty()) {
-            std::cout << "No circuit elements found. Cannot run DC analysis." << std::endl;
+            SPICE_LOG_WARN(Parser, "No circuit elements found. Cannot run DC analysis.");
             return;
         }
         
-        DCAnalysis dcAnalysis(elements, numNodes);
+        DCAnalysis dcAnalysis(elements, getNumNodes());
         dcAnalysis.solve();
 
+    } else if (command == ".save" || command == ".probe") {
+        // .save v(out) i(v1) ... [interval=<time>]
+        for (size_t i = 1; i < tokens.size(); i++) {
+            std::string_view token = tokens[i];
+            constexpr std::string_view intervalKey = "interval=";
+            if (token.size() > intervalKey.size() &&
+                std::equal(intervalKey.begin(), intervalKey.end(), token.begin(),
+                           [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); })) {
+                saveInterval = parseValue(token.substr(intervalKey.size()));
+            } else {
+                addSave(token);
+            }
+        }
     } else {
-        std::cout << "Unknown command: " << command << std::endl;
+        SPICE_LOG_WARN(Parser, "Unknown command: " << command);
     }
 }
 
-int SPICEParser::getNodeNumber(const std::string& nodeName) {
-    // Convert to lowercase for case-insensitive comparison
-    std::string lowerNode = nodeName;
-    std::transform(lowerNode.begin(), lowerNode.end(), lowerNode.begin(), ::tolower);
+void SPICEParser::addSave(std::string_view signal) {
+    std::string name(signal);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
     
-    auto it = nodeMap.find(lowerNode);
-    if (it != nodeMap.end()) {
-        return it->second;
-    } else {
-        // New node, assign next number
-        nodeMap[lowerNode] = numNodes;
-        return numNodes++;
+    if (name == "all") {
+        saveAll = true;
+        return;
+    }
+    bool voltage = name.size() > 3 && name.compare(0, 2, "v(") == 0 && name.back() == ')';
+    bool current = name.size() > 3 && name.compare(0, 2, "i(") == 0 && name.back() == ')';
+    if (voltage || current) {
+        name = name.substr(2, name.size() - 3);
+    }
+    if (name.empty() || name.find_first_of("(),") != std::string::npos) {
+        SPICE_LOG_WARN(Parser, "Unsupported signal in .save: " << signal);
+        return;
+    }
+    (current ? saveCurrents : saveNodes).push_back(name);
+}
+
+SaveSettings SPICEParser::getSaveSettings() const {
+    SaveSettings settings;
+    settings.all = saveAll || (saveNodes.empty() && saveCurrents.empty());
+    settings.currents = saveCurrents;
+    settings.interval = saveInterval;
+    for (const auto& name : saveNodes) {
+        int node = nodes.find(name);
+        if (node < 0) {
+            SPICE_LOG_WARN(Parser, "Cannot save v(" << name << "): no such node");
+        } else if (node > 0) {
+            settings.nodes.push_back(node);
+        }
     }
+    return settings;
+}
+
+int SPICEParser::getNodeNumber(std::string_view nodeName) {
+    // Case-insensitive; new nodes get the next number
+    return nodes.intern(nodeName);
 }
 
-void SPICEParser::parseResistor(const std::vector<std::string>& tokens) {
+void SPICEParser::parseResistor(const SPICETokens& tokens) {
     if (tokens.size() < 4) {
-        std::cerr << "Invalid resistor specification" << std::endl;
+        SPICE_LOG_ERROR(Parser, "Invalid resistor specification");
         return;
     }
     
-    std::string name = tokens[0];
-    std::string node1 = tokens[1];
-    std::string node2 = tokens[2];
-    std::string value = tokens[3];
+    std::string_view name = tokens[0];
+    std::string_view node1 = tokens[1];
+    std::string_view node2 = tokens[2];
+    std::string_view value = tokens[3];
     
     // Map nodes to numbers
     int n1 = getNodeNumber(node1);
@@ -187,40 +480,39 @@ void SPICEParser::parseResistor(const std::vector<std::string>& tokens) {
     // Parse resistance value
     double resistance = parseValue(value);
     
-    std::cout << "Resistor " << name << ": " << n1 << " to " << n2 
-                << ", R=" << resistance << " ohms" << std::endl;
+    SPICE_LOG_DEBUG(Parser, "Resistor " << name << ": " << n1 << " to " << n2 
+                            << ", R=" << resistance << " ohms");
     
-    auto resistor = std::make_unique<Resistor>(name, resistance);
+    auto resistor = std::make_unique<Resistor>(std::string(name), resistance);
     resistor->setNodeForPin(0, n1);  // Set node for pin 1
     resistor->setNodeForPin(1, n2);  // Set node for pin 2
     elements.push_back(std::move(resistor));
 }
 
-void SPICEParser::parseCapacitor(const std::vector<std::string>& tokens) {
-    std::string name = tokens[0];
-    std::string node1 = tokens[1];
-    std::string node2 = tokens[2];
-    std::string value = tokens[3];
+void SPICEParser::parseCapacitor(const SPICETokens& tokens) {
+    std::string_view name = tokens[0];
+    std::string_view node1 = tokens[1];
+    std::string_view node2 = tokens[2];
+    std::string_view value = tokens[3];
 
     int n1 = getNodeNumber(node1);
     int n2 = getNodeNumber(node2);
 
     double capacitance = parseValue(value);
 
-    std::cout << "Capacitance " << name << ": " << n1 << " to " << n2 
-            << ", C=" << capacitance << " farads" << std::endl;
+    SPICE_LOG_DEBUG(Parser, "Capacitance " << name << ": " << n1 << " to " << n2 
+                            << ", C=" << capacitance << " farads");
 
-    auto capacitor = std::make_unique<Capacitor>(name, capacitance);
+    auto capacitor = std::make_unique<Capacitor>(std::string(name), capacitance);
     capacitor->setNodeForPin(0, n1);  // Set node for pin 1
     capacitor->setNodeForPin(1, n2);  // Set node for pin 2
     elements.push_back(std::move(capacitor));
 }
 
-void SPICEParser::parseVoltageSource(const std::vector<std::string>& tokens) {
-    std::string name = tokens[0];
-    std::string node1 = tokens[1];
-    std::string node2 = tokens[2];
-    std::string value = tokens[3];
+void SPICEParser::parseVoltageSource(const SPICETokens& tokens) {
+    std::string_view name = tokens[0];
+    std::string_view node1 = tokens[1];
+    std::string_view node2 = tokens[2];
 
     int n1 = getNodeNumber(node1);
     int n2 = getNodeNumber(node2);
@@ -237,97 +529,97 @@ void SPICEParser::parseVoltageSource(const std::vector<std::string>& tokens) {
         }
     }
 
-    std::cout << "Voltage Source " << name << ": " << n1 << " to " << n2 
-            << ", V=" << voltage << " volts" << std::endl;
+    SPICE_LOG_DEBUG(Parser, "Voltage Source " << name << ": " << n1 << " to " << n2 
+                            << ", V=" << voltage << " volts");
     
-    auto vsource = std::make_unique<VoltageSource>(name, voltage);
+    auto vsource = std::make_unique<VoltageSource>(std::string(name), voltage);
     vsource->setNodeForPin(0, n1);  // Set node for pin 1
     vsource->setNodeForPin(1, n2);  // Set node for pin 2
     elements.push_back(std::move(vsource));
 }
 
-void SPICEParser::parseInductor(const std::vector<std::string>& tokens) {
+void SPICEParser::parseInductor(const SPICETokens& tokens) {
     if (tokens.size() < 4) {
-        std::cerr << "Invalid inductor specification" << std::endl;
+        SPICE_LOG_ERROR(Parser, "Invalid inductor specification");
         return;
     }
     
-    std::string name = tokens[0];
-    std::string node1 = tokens[1];
-    std::string node2 = tokens[2];
-    std::string value = tokens[3];
+    std::string_view name = tokens[0];
+    std::string_view node1 = tokens[1];
+    std::string_view node2 = tokens[2];
+    std::string_view value = tokens[3];
     
     int n1 = getNodeNumber(node1);
     int n2 = getNodeNumber(node2);
     
     double inductance = parseValue(value);
     
-    std::cout << "Inductor " << name << ": " << n1 << " to " << n2 
-              << ", L=" << inductance << " henries" << std::endl;
+    SPICE_LOG_DEBUG(Parser, "Inductor " << name << ": " << n1 << " to " << n2 
+                            << ", L=" << inductance << " henries");
     
-    auto inductor = std::make_unique<Inductor>(name, inductance);
+    auto inductor = std::make_unique<Inductor>(std::string(name), inductance);
     inductor->setNodeForPin(0, n1);
     inductor->setNodeForPin(1, n2);
     elements.push_back(std::move(inductor));
 }
 
-void SPICEParser::parseDiode(const std::vector<std::string>& tokens) {
+void SPICEParser::parseDiode(const SPICETokens& tokens) {
     if (tokens.size() < 4) {
-        std::cerr << "Invalid diode specification" << std::endl;
+        SPICE_LOG_ERROR(Parser, "Invalid diode specification");
         return;
     }
     
-    std::string name = tokens[0];
-    std::string anode = tokens[1];
-    std::string cathode = tokens[2];
-    std::string model = tokens[3];
+    std::string_view name = tokens[0];
+    std::string_view anode = tokens[1];
+    std::string_view cathode = tokens[2];
+    std::string_view model = tokens[3];
     
     int n1 = getNodeNumber(anode);
     int n2 = getNodeNumber(cathode);
     
-    std::cout << "Diode " << name << ": " << n1 << " to " << n2 
-              << ", Model=" << model << std::endl;
+    SPICE_LOG_DEBUG(Parser, "Diode " << name << ": " << n1 << " to " << n2 
+                            << ", Model=" << model);
     
-    auto diode = std::make_unique<Diode>(name, model);
+    auto diode = std::make_unique<Diode>(std::string(name), std::string(model));
     diode->setNodeForPin(0, n1);  // anode
     diode->setNodeForPin(1, n2);  // cathode
     elements.push_back(std::move(diode));
 }
 
-void SPICEParser::parseMOSFET(const std::vector<std::string>& tokens) {
+void SPICEParser::parseMOSFET(const SPICETokens& tokens) {
     if (tokens.size() < 6) {
-        std::cerr << "Invalid MOSFET specification" << std::endl;
+        SPICE_LOG_ERROR(Parser, "Invalid MOSFET specification");
         return;
     }
     
-    std::string name = tokens[0];
-    std::string drain = tokens[1];
-    std::string gate = tokens[2];
-    std::string source = tokens[3];
-    std::string bulk = tokens[4];
-    std::string model = tokens[5];
+    std::string_view name = tokens[0];
+    std::string_view drain = tokens[1];
+    std::string_view gate = tokens[2];
+    std::string_view source = tokens[3];
+    std::string_view bulk = tokens[4];
+    std::string_view model = tokens[5];
     
     int nd = getNodeNumber(drain);
     int ng = getNodeNumber(gate);
     int ns = getNodeNumber(source);
     int nb = getNodeNumber(bulk);
     
-    std::cout << "MOSFET " << name << ": D=" << nd << " G=" << ng 
-              << " S=" << ns << " B=" << nb << ", Model=" << model << std::endl;
+    SPICE_LOG_DEBUG(Parser, "MOSFET " << name << ": D=" << nd << " G=" << ng 
+                            << " S=" << ns << " B=" << nb << ", Model=" << model);
     
     // Determine if NMOS or PMOS based on model name
-    std::string lowerModel = model;
+    std::string lowerModel(model);
     std::transform(lowerModel.begin(), lowerModel.end(), lowerModel.begin(), ::tolower);
     
     if (lowerModel.find("pmos") != std::string::npos || lowerModel.find("pfet") != std::string::npos) {
-        auto pmos = std::make_unique<PMOSFET>(name, model);
+        auto pmos = std::make_unique<PMOSFET>(std::string(name), std::string(model));
         pmos->setNodeForPin(0, nd);  // drain
         pmos->setNodeForPin(1, ng);  // gate
         pmos->setNodeForPin(2, ns);  // source
         pmos->setNodeForPin(3, nb);  // bulk
         elements.push_back(std::move(pmos));
     } else {
-        auto nmos = std::make_unique<NMOSFET>(name, model);
+        auto nmos = std::make_unique<NMOSFET>(std::string(name), std::string(model));
         nmos->setNodeForPin(0, nd);  // drain
         nmos->setNodeForPin(1, ng);  // gate
         nmos->setNodeForPin(2, ns);  // source
@@ -336,13 +628,13 @@ void SPICEParser::parseMOSFET(const std::vector<std::string>& tokens) {
     }
 }
 
-void SPICEParser::parseComponent(const std::vector<std::string>& tokens) {
+void SPICEParser::parseComponent(const SPICETokens& tokens) {
     if (tokens.size() < 3) {
-        std::cerr << "Invalid component line (too few tokens)" << std::endl;
+        SPICE_LOG_ERROR(Parser, "Invalid component line (too few tokens)");
         return;
     }
     
-    std::string name = tokens[0];
+    std::string_view name = tokens[0];
     char componentType = std::tolower(name[0]);
     
     switch (componentType) {
@@ -355,60 +647,43 @@ void SPICEParser::parseComponent(const std::vector<std::string>& tokens) {
         case 'v': // Voltage source
             parseVoltageSource(tokens);
             break;
+        case 'l': // Inductor
+            parseInductor(tokens);
+            break;
+        case 'd': // Diode
+            parseDiode(tokens);
+            break;
         case 'i': // Current source
             //parseCurrentSource(tokens);
             break;
         case 'm': // MOSFET
-            //parseMOSFET(tokens);
+            parseMOSFET(tokens);
             break;
         default:
-            std::cout << "Unknown component type: " << componentType 
-                        << " in " << name << std::endl;
+            SPICE_LOG_WARN(Parser, "Unknown component type: " << componentType 
+                                   << " in " << name);
     }
 }
-double SPICEParser::parseValue(const std::string& valueStr) {
+double SPICEParser::parseValue(std::string_view valueStr) {
     if (valueStr.empty()) return 0.0;
     
-    // Handle engineering notation
-    std::string str = valueStr;
-    std::transform(str.begin(), str.end(), str.begin(), ::tolower);
-    
-    double multiplier = 1.0;
-    char lastChar = str.back();
-    
-    switch (lastChar) {
-        case 't': multiplier = 1e12; str.pop_back(); break;
-        case 'g': multiplier = 1e9;  str.pop_back(); break;
-        case 'k': multiplier = 1e3;  str.pop_back(); break;
-        case 'm': 
-            // Could be 'meg' (1e6) or 'm' (1e-3)
-            if (str.length() >= 3 && str.substr(str.length()-3) == "meg") {
-                multiplier = 1e6;
-                str = str.substr(0, str.length()-3);
-            } else {
-                multiplier = 1e-3;
-                str.pop_back();
-            }
-            break;
-        case 'u': multiplier = 1e-6; str.pop_back(); break;
-        case 'n': multiplier = 1e-9; str.pop_back(); break;
-        case 'p': multiplier = 1e-12; str.pop_back(); break;
-        case 'f': multiplier = 1e-15; str.pop_back(); break;
-    }
+    const char* first = valueStr.data();
+    const char* last = first + valueStr.size();
+    if (*first == '+') ++first;  // from_chars takes no explicit plus sign
     
-    try {
-        double value = std::stod(str);
-        return value * multiplier;
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing value: " << valueStr << std::endl;
+    double value = 0.0;
+    const char* suffix = parseNumber(first, last, value);
+    if (!suffix) {
+        SPICE_LOG_ERROR(Parser, "Error parsing value: " << valueStr);
         return 0.0;
     }
+    return value * engineeringMultiplier(std::string_view(suffix, last - suffix));
 }
 
 void SPICEParser::printParsedElements() {
     std::cout << "\n=== Parsed Elements Debug ===" << std::endl;
     std::cout << "Total elements: " << elements.size() << std::endl;
-    std::cout << "Number of nodes: " << numNodes << std::endl;
+    std::cout << "Number of nodes: " << nodes.size() << std::endl;
     
     for (size_t i = 0; i < elements.size(); i++) {
         const auto& element = elements[i];
@@ -9,33 +9,104 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <string_view>
 
 #include "circuit_element.h"
+#include "node_interner.h"
 #include "simulation/dc_analysis.h"
 #include "simulation/transient_analysis.h"
+#include "util/mapped_file.h"
+#include "util/perf_stats.h"
+
+// Tokens of one netlist statement; they point into the tokenizer's buffer
+using SPICETokens = std::vector<std::string_view>;
+
+// Splits a netlist into statements in a single pass over one buffer: the
+// mapped file, a copy of a stream, or a caller's string. A statement is a
+// line plus any following lines that start with '+'. Lines starting with
+// '*' and everything after ';' are comments.
+class SPICETokenizer{
+    private:
+        MappedFile file;
+        std::string buffer;
+        const char* pos = nullptr;
+        const char* end = nullptr;
+        
+        std::string_view takeLine();
+        static void splitLine(std::string_view line, SPICETokens& tokens);
+    public:
+        void loadFile(const std::string& filename);
+        void loadStream(std::istream& input);
+        // The text is not copied and must outlive the tokenizer
+        void loadString(std::string_view text);
+        
+        // Tokens of the next non-empty statement; false at the end. The
+        // views stay valid until the tokenizer is reloaded or destroyed.
+        bool next(SPICETokens& tokens);
+        
+        // The text not yet tokenized
+        std::string_view remaining() const {
+            return std::string_view(pos, end - pos);
+        }
+};
 
 class SPICEParser{
     private:
         std::vector<std::unique_ptr<CircuitElement>> elements;
-        std::map<std::string, int> nodeMap;
-        int numNodes = 0;
+        NodeInterner nodes;
         TransientSettings* transientSettings = nullptr;
+        bool dcRequested = false;
+        std::vector<std::string> saveNodes;     // .save/.probe, resolved when read
+        std::vector<std::string> saveCurrents;
+        bool saveAll = false;
+        double saveInterval = 0.0;
+        bool runAnalyses = true;
+        int parseThreads = 1;
+        PerfStats stats;
+
+        void reset();
+        void parseLines(SPICETokenizer& tokenizer, ScopedPhaseTimer& timer);
+        void parseChunks(std::string_view text, int threads, ScopedPhaseTimer& timer);
 
     public:
         void parseFile(const std::string& filename);
-        void parseCommand(const std::vector<std::string>& tokens);
-        void parseComponent(const std::vector<std::string>& tokens);
-        double parseValue(const std::string& valueStr);
-        int getNodeNumber(const std::string& nodeName);
-        void parseResistor(const std::vector<std::string>& tokens);
-        void parseCapacitor(const std::vector<std::string>& tokens);
-        void parseVoltageSource(const std::vector<std::string>& tokens);
-        void parseInductor(const std::vector<std::string>& tokens);
-        void parseDiode(const std::vector<std::string>& tokens);
-        void parseMOSFET(const std::vector<std::string>& tokens);
+        // Same as parseFile, for a netlist already in memory
+        void parseStream(std::istream& input);
+        void parseString(const std::string& netlist);
+        // Builds the element list straight from schematic components,
+        // without writing or parsing a netlist. Ground symbols and
+        // components with unconnected pins are skipped, like the netlist
+        // generator does; node ids are renumbered in order of appearance.
+        void loadCircuit(const std::vector<std::unique_ptr<CircuitElement>>& components);
+        // Analysis commands for circuits built with loadCircuit; they are
+        // only recorded, as with setRunAnalyses(false)
+        void setTransientSettings(const TransientSettings& settings);
+        void setDCAnalysis(bool requested) {
+            dcRequested = requested;
+        }
+        // A signal for transient analyses to record, as written after
+        // .save: v(node), i(vsource), a bare node name, or all. Without
+        // any, every node voltage and source current is recorded.
+        void addSave(std::string_view signal);
+        // Record at most one point per interval (0: every time step)
+        void setSaveInterval(double interval) {
+            saveInterval = interval;
+        }
+        void parseCommand(const SPICETokens& tokens);
+        void parseComponent(const SPICETokens& tokens);
+        // A number with an optional engineering suffix (t g k m meg u n p
+        // f); trailing unit letters such as the V in 5V are ignored
+        double parseValue(std::string_view valueStr);
+        int getNodeNumber(std::string_view nodeName);
+        void parseResistor(const SPICETokens& tokens);
+        void parseCapacitor(const SPICETokens& tokens);
+        void parseVoltageSource(const SPICETokens& tokens);
+        void parseInductor(const SPICETokens& tokens);
+        void parseDiode(const SPICETokens& tokens);
+        void parseMOSFET(const SPICETokens& tokens);
         void printParsedElements();
-        //void parseCurrentSource(const std::vector<std::string>& tokens);
-        //void parseMOSFET(const std::vector<std::string>& tokens);
+        //void parseCurrentSource(const SPICETokens& tokens);
+        //void parseMOSFET(const SPICETokens& tokens);
 
         
         const std::vector<std::unique_ptr<CircuitElement>>& getElements() const { 
@@ -43,20 +114,48 @@ class SPICEParser{
         }
         
         int getNumNodes() const { 
-            return numNodes; 
+            return static_cast<int>(nodes.size()); 
+        }
+        
+        // Node names by node number; gnd and ground are aliases of 0
+        const NodeInterner& getNodes() const {
+            return nodes;
+        }
+        
+        // By default .tran and .op/.dc commands run their analysis as soon
+        // as they are parsed. With this off they are only recorded, and the
+        // caller runs them through the getters below.
+        void setRunAnalyses(bool run) {
+            runAnalyses = run;
+        }
+        
+        // Large netlists are split at statement boundaries and their pieces
+        // parsed on this many threads (0: one per hardware thread). Nodes
+        // and elements are numbered and ordered exactly as a serial parse
+        // would; commands are applied after all components, in file order.
+        void setParseThreads(int threads) {
+            parseThreads = threads;
+        }
+        
+        // Settings of the netlist's .tran command, or null
+        const TransientSettings* getTransientSettings() const {
+            return transientSettings;
+        }
+        
+        bool hasDCAnalysis() const {
+            return dcRequested;
+        }
+        
+        // Signals requested by .save/.probe commands and addSave(); node
+        // names are looked up now, so they may precede the components
+        SaveSettings getSaveSettings() const;
+        
+        // Parse time of the last parse or loadCircuit(), excluding analyses run by
+        // .tran/.op commands in the netlist
+        const PerfStats& getStats() const {
+            return stats;
         }
 
 };
 
-class SPICETokenizer{
-    private:
-        std::vector<std::string> lines;
-        size_t current_line;
-    public:
-        std::vector<std::string> tokenizeLine(const std::string& line);
-        bool hasMoreLines();
-        std::string getNextLine();
-        void loadFile(const std::string& filename);
-};
-
 #endif
\ No newline at end of file
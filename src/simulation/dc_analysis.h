@@ -5,42 +5,57 @@
 #include <map>
 #include <memory>
 #include "parser/circuit_element.h"
-#include "simulation/dc_analysis.h"
+#include "simulation/sparse_matrix.h"
+#include "simulation/linear_solver.h"
+#include "simulation/device_stamper.h"
+#include "util/perf_stats.h"
 
 
 class DCAnalysis {
 private:
-    std::vector<std::unique_ptr<CircuitElement>>& elements;
+    const std::vector<std::unique_ptr<CircuitElement>>& elements;
     int numNodes;
     int matrixSize;
     
     // Use standard C++ containers instead of Eigen
-    std::vector<std::vector<double>> G;  // Conductance matrix
+    SparseMatrix G;                      // Conductance matrix
+    LinearSolver lu;                     // Factorization of G, reused across solves
     std::vector<double> b;               // Right-hand side vector
     std::vector<double> x;               // Solution vector
     
     std::map<std::string, int> voltageSourceIndex;
     
+    DeviceSet devices;
+    DeviceStamper stamper;
+    
+    PerfStats stats;
+    bool solved = false;
+    
 public:
-    DCAnalysis(std::vector<std::unique_ptr<CircuitElement>>& elems, int nodes);
+    DCAnalysis(const std::vector<std::unique_ptr<CircuitElement>>& elems, int nodes);
     
     void buildMNAMatrix();
     void solve();
     void printResults();
     
+    // False if the last solve() found no operating point (singular matrix
+    // or no equations); node voltages then read as zero
+    bool hasSolution() const { return solved; }
+    
     double getNodeVoltage(int node) const;
     double getVoltagSourceCurrent(const std::string& vsourceName) const;
     
+    // Matrix ordering used by the sparse LU factorization (default AMD)
+    void setOrdering(OrderingMethod method) { lu.setOrdering(method); }
+    // Systems smaller than this use the dense LU
+    void setDenseThreshold(int size) { lu.setDenseThreshold(size); }
+    const OrderingStats& getOrderingStats() const { return lu.orderingStats(); }
+    
+    // Phase timings and counters of the last solve()
+    const PerfStats& getStats() const { return stats; }
+    
 private:
-    void addResistor(const Resistor* resistor);
-    void addVoltageSource(const VoltageSource* vsource);
-    void addCapacitor(const Capacitor* capacitor);
-    void addInductor(const Inductor* inductor);
-    void addDiode(const Diode* diode);
-    void addMOSFET(const NMOSFET* mosfet);
-    
-    void addMatrixEntry(int row, int col, double value);
-    bool gaussianElimination();
+    bool solveLinearSystem();
     void printMatrix() const;
     void reset();
 };
@@ -0,0 +1,219 @@
+#include "dense_matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+DenseMatrix::DenseMatrix(int rows, int cols) {
+    resize(rows, cols);
+}
+
+DenseMatrix::DenseMatrix(const DenseMatrix& other) {
+    *this = other;
+}
+
+DenseMatrix& DenseMatrix::operator=(const DenseMatrix& other) {
+    if (this != &other) {
+        resize(other.numRows, other.numCols);
+        if (storage) {
+            std::memcpy(storage, other.storage,
+                        sizeof(double) * static_cast<std::size_t>(numRows) * rowStride);
+        }
+    }
+    return *this;
+}
+
+DenseMatrix::~DenseMatrix() {
+    release();
+}
+
+void DenseMatrix::release() {
+    if (storage) {
+        ::operator delete(storage, std::align_val_t(alignment));
+        storage = nullptr;
+    }
+}
+
+void DenseMatrix::resize(int rows, int cols) {
+    int stride = (cols + 7) & ~7;
+    std::size_t oldCount = static_cast<std::size_t>(numRows) * rowStride;
+    std::size_t newCount = static_cast<std::size_t>(rows) * stride;
+
+    if (newCount != oldCount || !storage) {
+        release();
+        if (newCount > 0) {
+            storage = static_cast<double*>(
+                ::operator new(sizeof(double) * newCount, std::align_val_t(alignment)));
+        }
+    }
+
+    numRows = rows;
+    numCols = cols;
+    rowStride = stride;
+    setZero();
+}
+
+void DenseMatrix::setZero() {
+    if (storage) {
+        std::memset(storage, 0, sizeof(double) * static_cast<std::size_t>(numRows) * rowStride);
+    }
+}
+
+void DenseMatrix::assign(const SparseMatrix& A) {
+    if (numRows != A.size() || numCols != A.size()) {
+        resize(A.size(), A.size());
+    } else {
+        setZero();
+    }
+
+    const auto& rowPtr = A.rowPointers();
+    const auto& colIdx = A.colIndices();
+    const auto& vals = A.values();
+    for (int i = 0; i < A.size(); i++) {
+        double* r = row(i);
+        for (int p = rowPtr[i]; p < rowPtr[i + 1]; p++) {
+            r[colIdx[p]] += vals[p];
+        }
+    }
+}
+
+bool DenseLU::factor(const SparseMatrix& A) {
+    lu.assign(A);
+    columns.clear();
+    return factorInPlace();
+}
+
+bool DenseLU::factor(const DenseMatrix& A) {
+    lu = A;
+    columns.clear();
+    return factorInPlace();
+}
+
+bool DenseLU::factor(const SparseMatrix& A, const std::vector<int>& columnOrder) {
+    lu.assign(A);
+    columns = columnOrder;
+    work.resize(lu.cols());
+    for (int i = 0; i < lu.rows(); i++) {
+        double* r = lu.row(i);
+        std::copy(r, r + lu.cols(), work.begin());
+        for (int k = 0; k < lu.cols(); k++) {
+            r[k] = work[columns[k]];
+        }
+    }
+    return factorInPlace();
+}
+
+bool DenseLU::factorInPlace() {
+    n = lu.rows();
+    factored = false;
+    perm.resize(n);
+    rowScale.assign(n, 0.0);
+    colScale.assign(n, 0.0);
+    for (int i = 0; i < n; i++) {
+        perm[i] = i;
+        const double* r = lu.row(i);
+        for (int j = 0; j < n; j++) {
+            rowScale[i] = std::max(rowScale[i], std::abs(r[j]));
+            colScale[j] = std::max(colScale[j], std::abs(r[j]));
+        }
+    }
+
+    for (int kb = 0; kb < n; kb += blockSize) {
+        int kend = std::min(kb + blockSize, n);
+
+        // Panel: unblocked LU of columns kb..kend-1, rows kb..n-1
+        for (int k = kb; k < kend; k++) {
+            int pivotRow = k;
+            double pivotMag = std::abs(lu(perm[k], k));
+            for (int i = k + 1; i < n; i++) {
+                double mag = std::abs(lu(perm[i], k));
+                if (mag > pivotMag) {
+                    pivotMag = mag;
+                    pivotRow = i;
+                }
+            }
+            if (isNegligiblePivot(pivotMag, rowScale[perm[pivotRow]], colScale[k])) {
+                return false;
+            }
+            std::swap(perm[k], perm[pivotRow]);
+
+            const double* SPICE_RESTRICT rowK = lu.row(perm[k]);
+            double pivot = rowK[k];
+            for (int i = k + 1; i < n; i++) {
+                double* SPICE_RESTRICT rowI = lu.row(perm[i]);
+                double l = rowI[k] / pivot;
+                rowI[k] = l;
+                for (int j = k + 1; j < kend; j++) {
+                    rowI[j] -= l * rowK[j];
+                }
+            }
+        }
+
+        if (kend == n) break;
+
+        // U12: apply the unit lower triangle of the panel to the block rows
+        for (int k = kb; k < kend; k++) {
+            const double* SPICE_RESTRICT rowK = lu.row(perm[k]);
+            for (int i = k + 1; i < kend; i++) {
+                double* SPICE_RESTRICT rowI = lu.row(perm[i]);
+                double l = rowI[k];
+                for (int j = kend; j < n; j++) {
+                    rowI[j] -= l * rowK[j];
+                }
+            }
+        }
+
+        // Trailing update A22 -= L21 * U12, tiled over columns
+        for (int jb = kend; jb < n; jb += columnTile) {
+            int jend = std::min(jb + columnTile, n);
+            for (int i = kend; i < n; i++) {
+                double* SPICE_RESTRICT rowI = lu.row(perm[i]);
+                for (int k = kb; k < kend; k++) {
+                    double l = rowI[k];
+                    if (l == 0.0) continue;
+                    const double* SPICE_RESTRICT rowK = lu.row(perm[k]);
+                    for (int j = jb; j < jend; j++) {
+                        rowI[j] -= l * rowK[j];
+                    }
+                }
+            }
+        }
+    }
+
+    factored = true;
+    return true;
+}
+
+void DenseLU::solve(const std::vector<double>& b, std::vector<double>& x) {
+    work.resize(n);
+    double* SPICE_RESTRICT y = work.data();
+
+    // L y = P b (unit diagonal)
+    for (int i = 0; i < n; i++) {
+        const double* SPICE_RESTRICT rowI = lu.row(perm[i]);
+        double sum = b[perm[i]];
+        for (int j = 0; j < i; j++) {
+            sum -= rowI[j] * y[j];
+        }
+        y[i] = sum;
+    }
+
+    // U x = y
+    for (int i = n - 1; i >= 0; i--) {
+        const double* SPICE_RESTRICT rowI = lu.row(perm[i]);
+        double sum = y[i];
+        for (int j = i + 1; j < n; j++) {
+            sum -= rowI[j] * y[j];
+        }
+        y[i] = sum / rowI[i];
+    }
+
+    if (columns.empty()) {
+        x.assign(work.begin(), work.end());
+        return;
+    }
+    x.resize(n);
+    for (int k = 0; k < n; k++) {
+        x[columns[k]] = y[k];
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef DENSE_MATRIX_H
+#define DENSE_MATRIX_H
+
+#include <vector>
+#include <cstddef>
+#include "simulation/sparse_matrix.h"
+
+#if defined(_MSC_VER)
+#define SPICE_RESTRICT __restrict
+#else
+#define SPICE_RESTRICT __restrict__
+#endif
+
+// Contiguous row-major dense matrix. Storage is 64-byte aligned and every row
+// is padded to a multiple of 8 doubles, so each row starts on a cache line
+// and inner loops over a row map onto full AVX2/NEON vectors.
+class DenseMatrix {
+private:
+    int numRows = 0;
+    int numCols = 0;
+    int rowStride = 0;
+    double* storage = nullptr;
+
+    static constexpr std::size_t alignment = 64;
+
+    void release();
+
+public:
+    DenseMatrix() = default;
+    DenseMatrix(int rows, int cols);
+    DenseMatrix(const DenseMatrix& other);
+    DenseMatrix& operator=(const DenseMatrix& other);
+    ~DenseMatrix();
+
+    void resize(int rows, int cols);
+    void setZero();
+
+    // Zero the matrix and scatter A into it
+    void assign(const SparseMatrix& A);
+
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+    int stride() const { return rowStride; }
+
+    double* row(int i) { return storage + static_cast<std::size_t>(i) * rowStride; }
+    const double* row(int i) const { return storage + static_cast<std::size_t>(i) * rowStride; }
+    double& operator()(int i, int j) { return row(i)[j]; }
+    double operator()(int i, int j) const { return row(i)[j]; }
+};
+
+// Dense LU with partial pivoting, blocked right-looking variant.
+//
+// Rows are never moved: pivoting only updates the permutation vector, and
+// row k of the factored matrix lives in physical row perm[k]. The trailing
+// update A22 -= L21 * U12 is tiled by column so a block of U12 rows stays in
+// cache while every trailing row streams past it.
+class DenseLU {
+private:
+    DenseMatrix lu;
+    std::vector<int> perm;
+    std::vector<int> columns;       // column of A eliminated at each step
+    std::vector<double> rowScale;   // largest |A| per row and per (permuted)
+    std::vector<double> colScale;   // column, for the pivot test
+    std::vector<double> work;
+    int n = 0;
+    bool factored = false;
+
+    bool factorInPlace();
+
+public:
+    static constexpr int blockSize = 32;      // panel width
+    static constexpr int columnTile = 256;    // trailing update tile width
+
+    // Pivots are tested with isNegligiblePivot()
+    bool factor(const SparseMatrix& A);
+    bool factor(const DenseMatrix& A);
+    // Eliminates the columns of A in the given order (columnOrder[k] is
+    // the column of step k), as the sparse LU does with its fill-reducing
+    // ordering
+    bool factor(const SparseMatrix& A, const std::vector<int>& columnOrder);
+
+    // Solve A x = b using the current factors
+    void solve(const std::vector<double>& b, std::vector<double>& x);
+
+    bool isFactored() const { return factored; }
+    int size() const { return n; }
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "device_banks.h"
+#include "device_kernels.h"
+#include "util/log.h"
+#include <cctype>
+
+void ResistorBank::clear() {
+    row1.clear();
+    row2.clear();
+    conductance.clear();
+    name.clear();
+}
+
+void ResistorBank::add(const Resistor& r, int r1, int r2) {
+    row1.push_back(r1);
+    row2.push_back(r2);
+    conductance.push_back(1.0 / r.r);
+    name.push_back(r.name);
+}
+
+void VoltageSourceBank::clear() {
+    row1.clear();
+    row2.clear();
+    branch.clear();
+    voltage.clear();
+    name.clear();
+}
+
+void VoltageSourceBank::add(const VoltageSource& v, int r1, int r2, int branchRow) {
+    row1.push_back(r1);
+    row2.push_back(r2);
+    branch.push_back(branchRow);
+    voltage.push_back(v.v);
+    name.push_back(v.name);
+}
+
+void CapacitorBank::clear() {
+    row1.clear();
+    row2.clear();
+    capacitance.clear();
+    name.clear();
+}
+
+void CapacitorBank::add(const Capacitor& c, int r1, int r2) {
+    row1.push_back(r1);
+    row2.push_back(r2);
+    capacitance.push_back(c.c);
+    name.push_back(c.name);
+}
+
+void InductorBank::clear() {
+    row1.clear();
+    row2.clear();
+    inductance.clear();
+    name.clear();
+}
+
+void InductorBank::add(const Inductor& l, int r1, int r2) {
+    row1.push_back(r1);
+    row2.push_back(r2);
+    inductance.push_back(l.l);
+    name.push_back(l.name);
+}
+
+void DiodeBank::clear() {
+    anode.clear();
+    cathode.clear();
+    Is.clear();
+    nVt.clear();
+    reverseLimit.clear();
+    name.clear();
+}
+
+void DiodeBank::add(const Diode& d, int rowAnode, int rowCathode) {
+    anode.push_back(rowAnode);
+    cathode.push_back(rowCathode);
+    Is.push_back(d.Is);
+    nVt.push_back(d.n * d.Vt);
+    reverseLimit.push_back(-5.0 * d.n * d.Vt);
+    name.push_back(d.name);
+}
+
+void DiodeBank::evaluate(const double* v, double* current, double* conductance) const {
+    evaluateDiodes(size(), v, Is.data(), nVt.data(), reverseLimit.data(), current, conductance);
+}
+
+void MOSFETBank::clear() {
+    drain.clear();
+    gate.clear();
+    source.clear();
+    beta.clear();
+    Vth.clear();
+    lambda.clear();
+    name.clear();
+}
+
+void MOSFETBank::add(const NMOSFET& m, int d, int g, int s) {
+    drain.push_back(d);
+    gate.push_back(g);
+    source.push_back(s);
+    beta.push_back(m.Kn * (m.W / m.L));
+    Vth.push_back(m.Vth);
+    lambda.push_back(m.lambda);
+    name.push_back(m.name);
+}
+
+void MOSFETBank::add(const PMOSFET& m, int d, int g, int s) {
+    drain.push_back(d);
+    gate.push_back(g);
+    source.push_back(s);
+    beta.push_back(m.Kp * (m.W / m.L));
+    // PMOS is evaluated with source-referenced voltages (Vsg, Vsd), for
+    // which the threshold is |Vth|
+    Vth.push_back(-m.Vth);
+    lambda.push_back(m.lambda);
+    name.push_back(m.name);
+}
+
+void MOSFETBank::evaluate(const double* vgs, const double* vds,
+                          double* id, double* gm, double* gds) const {
+    evaluateMOSFETs(size(), vgs, vds, beta.data(), Vth.data(), lambda.data(), id, gm, gds);
+}
+
+void MOSFETBank::evaluate(size_t i, double vgs, double vds,
+                          double& id, double& gm, double& gds) const {
+    evaluateMOSFETs(1, &vgs, &vds, &beta[i], &Vth[i], &lambda[i], &id, &gm, &gds);
+}
+
+void DeviceSet::clear() {
+    resistors.clear();
+    voltageSources.clear();
+    capacitors.clear();
+    inductors.clear();
+    diodes.clear();
+    nmos.clear();
+    pmos.clear();
+    unknown.clear();
+    order.clear();
+}
+
+void DeviceSet::build(const std::vector<std::unique_ptr<CircuitElement>>& elements, int numNodes,
+                      const std::map<std::string, int>& voltageSourceIndex) {
+    clear();
+
+    // Ground and out-of-range nodes do not appear in the matrix
+    auto nodeRow = [numNodes](const CircuitElement* element, int pin) {
+        int node = element->pins[pin].node_id;
+        return (node > 0 && node < numNodes) ? node - 1 : -1;
+    };
+    auto append = [this](Kind kind, size_t index) {
+        order.emplace_back(kind, static_cast<int>(index));
+    };
+
+    for (const auto& element : elements) {
+        if (element->name.empty()) continue;
+        const CircuitElement* e = element.get();
+        char type = std::tolower(element->name[0]);
+
+        switch(type) {
+            case 'r':
+                append(Kind::RESISTOR, resistors.size());
+                resistors.add(*static_cast<const Resistor*>(e), nodeRow(e, 0), nodeRow(e, 1));
+                break;
+            case 'v': {
+                auto it = voltageSourceIndex.find(element->name);
+                if (it == voltageSourceIndex.end()) {
+                    SPICE_LOG_ERROR(DC, "Voltage source " << element->name << " not found in index map");
+                    break;
+                }
+                append(Kind::VOLTAGE_SOURCE, voltageSources.size());
+                voltageSources.add(*static_cast<const VoltageSource*>(e),
+                                   nodeRow(e, 0), nodeRow(e, 1), it->second);
+                break;
+            }
+            case 'c':
+                append(Kind::CAPACITOR, capacitors.size());
+                capacitors.add(*static_cast<const Capacitor*>(e), nodeRow(e, 0), nodeRow(e, 1));
+                break;
+            case 'l':
+                append(Kind::INDUCTOR, inductors.size());
+                inductors.add(*static_cast<const Inductor*>(e), nodeRow(e, 0), nodeRow(e, 1));
+                break;
+            case 'd':
+                append(Kind::DIODE, diodes.size());
+                diodes.add(*static_cast<const Diode*>(e), nodeRow(e, 0), nodeRow(e, 1));
+                break;
+            case 'm':
+                if (const NMOSFET* n = dynamic_cast<const NMOSFET*>(e)) {
+                    append(Kind::NMOS, nmos.size());
+                    nmos.add(*n, nodeRow(e, 0), nodeRow(e, 1), nodeRow(e, 2));
+                } else if (const PMOSFET* p = dynamic_cast<const PMOSFET*>(e)) {
+                    append(Kind::PMOS, pmos.size());
+                    pmos.add(*p, nodeRow(e, 0), nodeRow(e, 1), nodeRow(e, 2));
+                }
+                break;
+            default:
+                append(Kind::UNKNOWN, unknown.size());
+                unknown.push_back(element->name);
+        }
+    }
+}
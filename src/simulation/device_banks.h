@@ -0,0 +1,129 @@
+#ifndef DEVICE_BANKS_H
+#define DEVICE_BANKS_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include "parser/circuit_element.h"
+
+// Per-type device banks in structure-of-arrays layout.
+//
+// The CircuitElement objects are the editing model (names, GUI positions,
+// pin lists); the simulator copies what it needs out of them once into the
+// banks below. Node references are stored as matrix rows (node - 1, or -1
+// for ground) and model parameters are pre-combined, so evaluating every
+// device of one type is a linear sweep over a few contiguous arrays.
+
+struct ResistorBank {
+    std::vector<int> row1, row2;
+    std::vector<double> conductance;    // 1 / R
+    std::vector<std::string> name;
+
+    size_t size() const { return conductance.size(); }
+    void clear();
+    void add(const Resistor& r, int r1, int r2);
+};
+
+struct VoltageSourceBank {
+    std::vector<int> row1, row2;
+    std::vector<int> branch;            // branch current row
+    std::vector<double> voltage;
+    std::vector<std::string> name;
+
+    size_t size() const { return voltage.size(); }
+    void clear();
+    void add(const VoltageSource& v, int r1, int r2, int branchRow);
+};
+
+struct CapacitorBank {
+    std::vector<int> row1, row2;
+    std::vector<double> capacitance;
+    std::vector<std::string> name;
+
+    size_t size() const { return capacitance.size(); }
+    void clear();
+    void add(const Capacitor& c, int r1, int r2);
+};
+
+struct InductorBank {
+    std::vector<int> row1, row2;
+    std::vector<double> inductance;
+    std::vector<std::string> name;
+
+    size_t size() const { return inductance.size(); }
+    void clear();
+    void add(const Inductor& l, int r1, int r2);
+};
+
+struct DiodeBank {
+    std::vector<int> anode, cathode;
+    std::vector<double> Is;
+    std::vector<double> nVt;            // n * Vt
+    std::vector<double> reverseLimit;   // -5 n Vt: below this the diode is off
+    std::vector<std::string> name;
+
+    size_t size() const { return Is.size(); }
+    void clear();
+    void add(const Diode& d, int rowAnode, int rowCathode);
+
+    // Current and conductance dI/dV of every diode at anode-cathode
+    // voltages v; batched SIMD kernel, same model as Diode::evaluate
+    void evaluate(const double* v, double* current, double* conductance) const;
+};
+
+// Square-law MOSFET bank. NMOS and PMOS use separate banks; a PMOS bank is
+// evaluated with source-referenced voltages (vgs = Vsg, vds = Vsd).
+struct MOSFETBank {
+    std::vector<int> drain, gate, source;
+    std::vector<double> beta;           // K * W / L
+    std::vector<double> Vth;
+    std::vector<double> lambda;
+    std::vector<std::string> name;
+
+    size_t size() const { return beta.size(); }
+    void clear();
+    void add(const NMOSFET& m, int d, int g, int s);
+    void add(const PMOSFET& m, int d, int g, int s);
+
+    // Drain current, gm and gds of every device at (vgs, vds); batched SIMD
+    // kernel, same model as NMOSFET::evaluate
+    void evaluate(const double* vgs, const double* vds,
+                  double* id, double* gm, double* gds) const;
+    // Single device i
+    void evaluate(size_t i, double vgs, double vds, double& id, double& gm, double& gds) const;
+};
+
+// All devices of a netlist, resolved once from the element list.
+//
+// build() is the only place that dispatches on the element name and
+// dynamic_casts MOSFETs.
+class DeviceSet {
+public:
+    enum class Kind { RESISTOR, VOLTAGE_SOURCE, CAPACITOR, INDUCTOR, DIODE, NMOS, PMOS, UNKNOWN };
+
+    ResistorBank resistors;
+    VoltageSourceBank voltageSources;
+    CapacitorBank capacitors;
+    InductorBank inductors;
+    DiodeBank diodes;
+    MOSFETBank nmos;
+    MOSFETBank pmos;
+    std::vector<std::string> unknown;
+
+    // Netlist order as (kind, index into the bank of that kind); stamps are
+    // registered in this order so matrix sums match element order
+    std::vector<std::pair<Kind, int>> order;
+
+    // voltageSourceIndex maps source names to their branch rows
+    void build(const std::vector<std::unique_ptr<CircuitElement>>& elements, int numNodes,
+               const std::map<std::string, int>& voltageSourceIndex);
+    void clear();
+
+    // True if the matrix only depends on element values and the step size
+    bool isLinear() const {
+        return diodes.size() == 0 && nmos.size() == 0 && pmos.size() == 0 && unknown.empty();
+    }
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "device_kernels.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// exp(x) = 2^n * exp(r), n = round(x / ln 2), |r| <= ln(2) / 2, with exp(r)
+// from the Cephes rational approximation 1 + 2 r P(r^2) / (Q(r^2) - r P(r^2)).
+// The scale 2^n is applied in two halves so that n down to -1075 (subnormal
+// results) and up to 1024 stay within the exponent range.
+constexpr double log2e = 1.4426950408889634073599;
+constexpr double ln2Hi = 6.93145751953125e-1;
+constexpr double ln2Lo = 1.42860682030941723212e-6;
+constexpr double expMax = 709.782712893383996843;
+constexpr double expMin = -745.13321910194110842;
+constexpr double P0 = 1.26177193074810590878e-4;
+constexpr double P1 = 3.02994407707441961300e-2;
+constexpr double P2 = 9.99999999999999999910e-1;
+constexpr double Q0 = 3.00198505138664455042e-6;
+constexpr double Q1 = 2.52448340349684104192e-3;
+constexpr double Q2 = 2.27265548208155028766e-1;
+constexpr double Q3 = 2.00000000000000000009e0;
+// Adding this to an integer-valued double leaves the integer in the low
+// mantissa bits
+constexpr double roundMagic = 6755399441055744.0;  // 1.5 * 2^52
+
+inline double pow2(double k) {
+    double biased = k + (roundMagic + 1023.0);
+    std::uint64_t bits;
+    std::memcpy(&bits, &biased, sizeof(bits));
+    bits <<= 52;
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+inline double expLane(double x) {
+    double xc = x > expMax ? expMax : (x < expMin ? expMin : x);
+    double n = (xc * log2e + roundMagic) - roundMagic;  // round to nearest
+    double r = xc - n * ln2Hi - n * ln2Lo;
+    double rr = r * r;
+    double p = r * ((P0 * rr + P1) * rr + P2);
+    double q = ((Q0 * rr + Q1) * rr + Q2) * rr + Q3;
+    double e = 1.0 + 2.0 * (p / (q - p));
+    double n1 = n * 0.5;
+    n1 = (n1 + roundMagic) - roundMagic;
+    n1 = n1 > n * 0.5 ? n1 - 1.0 : n1;                  // floor(n / 2)
+    double y = e * pow2(n1) * pow2(n - n1);
+    y = x > expMax ? std::numeric_limits<double>::infinity() : y;
+    return x < expMin ? 0.0 : y;
+}
+
+inline void diodeLane(double v, double Is, double nVt, double reverseLimit,
+                      double& current, double& conductance) {
+    double e = expLane(v / nVt);
+    bool on = !(v < reverseLimit);
+    current = on ? Is * (e - 1.0) : -Is;
+    conductance = on ? (Is / nVt) * e : 1e-12;
+}
+
+inline void mosfetLane(double vgs, double vds, double beta, double Vth, double lambda,
+                       double& id, double& gm, double& gds) {
+    double vov = vgs - Vth;
+    double clm = 1 + lambda * vds;
+    double core = vov * vds - 0.5 * vds * vds;
+
+    double idTriode = beta * core * clm;
+    double gmTriode = beta * vds * clm;
+    double gdsTriode = beta * (vov - vds) * clm + beta * core * lambda;
+    double idSat = 0.5 * beta * vov * vov * clm;
+    double gmSat = beta * vov * clm;
+    double gdsSat = 0.5 * beta * lambda * vov * vov;
+
+    bool cutoff = vgs < Vth;
+    bool triode = vds < vov;
+    id = cutoff ? 0.0 : (triode ? idTriode : idSat);
+    gm = cutoff ? 0.0 : (triode ? gmTriode : gmSat);
+    gds = cutoff ? 1e-12 : (triode ? gdsTriode : gdsSat);
+}
+
+#if defined(__AVX2__)
+
+inline __m256d pow2x4(__m256d k) {
+    __m256i bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(roundMagic + 1023.0)));
+    return _mm256_castsi256_pd(_mm256_slli_epi64(bits, 52));
+}
+
+inline __m256d expx4(__m256d x) {
+    const __m256d maxv = _mm256_set1_pd(expMax);
+    const __m256d minv = _mm256_set1_pd(expMin);
+    __m256d xc = _mm256_min_pd(_mm256_max_pd(x, minv), maxv);
+
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(xc, _mm256_set1_pd(log2e)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(xc, _mm256_mul_pd(n, _mm256_set1_pd(ln2Hi)));
+    r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(ln2Lo)));
+    __m256d rr = _mm256_mul_pd(r, r);
+
+    __m256d p = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(P0), rr), _mm256_set1_pd(P1));
+    p = _mm256_add_pd(_mm256_mul_pd(p, rr), _mm256_set1_pd(P2));
+    p = _mm256_mul_pd(p, r);
+    __m256d q = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(Q0), rr), _mm256_set1_pd(Q1));
+    q = _mm256_add_pd(_mm256_mul_pd(q, rr), _mm256_set1_pd(Q2));
+    q = _mm256_add_pd(_mm256_mul_pd(q, rr), _mm256_set1_pd(Q3));
+
+    __m256d e = _mm256_div_pd(p, _mm256_sub_pd(q, p));
+    e = _mm256_add_pd(_mm256_set1_pd(1.0), _mm256_add_pd(e, e));
+
+    __m256d n1 = _mm256_floor_pd(_mm256_mul_pd(n, _mm256_set1_pd(0.5)));
+    __m256d y = _mm256_mul_pd(_mm256_mul_pd(e, pow2x4(n1)), pow2x4(_mm256_sub_pd(n, n1)));
+
+    y = _mm256_blendv_pd(y, _mm256_set1_pd(std::numeric_limits<double>::infinity()),
+                         _mm256_cmp_pd(x, maxv, _CMP_GT_OQ));
+    return _mm256_blendv_pd(y, _mm256_setzero_pd(), _mm256_cmp_pd(x, minv, _CMP_LT_OQ));
+}
+
+#endif
+
+} // namespace
+
+void batchExp(std::size_t count, const double* x, double* y) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd(y + i, expx4(_mm256_loadu_pd(x + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        y[i] = expLane(x[i]);
+    }
+}
+
+void evaluateDiodes(std::size_t count, const double* v,
+                    const double* Is, const double* nVt, const double* reverseLimit,
+                    double* current, double* conductance) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d gmin = _mm256_set1_pd(1e-12);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    for (; i + 4 <= count; i += 4) {
+        __m256d vi = _mm256_loadu_pd(v + i);
+        __m256d is = _mm256_loadu_pd(Is + i);
+        __m256d nvt = _mm256_loadu_pd(nVt + i);
+        __m256d off = _mm256_cmp_pd(vi, _mm256_loadu_pd(reverseLimit + i), _CMP_LT_OQ);
+
+        __m256d e = expx4(_mm256_div_pd(vi, nvt));
+        __m256d iOn = _mm256_mul_pd(is, _mm256_sub_pd(e, one));
+        __m256d gOn = _mm256_mul_pd(_mm256_div_pd(is, nvt), e);
+
+        _mm256_storeu_pd(current + i, _mm256_blendv_pd(iOn, _mm256_xor_pd(is, signBit), off));
+        _mm256_storeu_pd(conductance + i, _mm256_blendv_pd(gOn, gmin, off));
+    }
+#endif
+    for (; i < count; i++) {
+        diodeLane(v[i], Is[i], nVt[i], reverseLimit[i], current[i], conductance[i]);
+    }
+}
+
+void evaluateMOSFETs(std::size_t count, const double* vgs, const double* vds,
+                     const double* beta, const double* Vth, const double* lambda,
+                     double* id, double* gm, double* gds) {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d leak = _mm256_set1_pd(1e-12);
+    for (; i + 4 <= count; i += 4) {
+        __m256d g = _mm256_loadu_pd(vgs + i);
+        __m256d d = _mm256_loadu_pd(vds + i);
+        __m256d b = _mm256_loadu_pd(beta + i);
+        __m256d vth = _mm256_loadu_pd(Vth + i);
+        __m256d lam = _mm256_loadu_pd(lambda + i);
+
+        __m256d vov = _mm256_sub_pd(g, vth);
+        __m256d clm = _mm256_add_pd(one, _mm256_mul_pd(lam, d));
+        __m256d core = _mm256_sub_pd(_mm256_mul_pd(vov, d),
+                                     _mm256_mul_pd(_mm256_mul_pd(half, d), d));
+        __m256d halfBetaVov2 = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(half, b), vov), vov);
+
+        __m256d idTriode = _mm256_mul_pd(_mm256_mul_pd(b, core), clm);
+        __m256d gmTriode = _mm256_mul_pd(_mm256_mul_pd(b, d), clm);
+        __m256d gdsTriode = _mm256_add_pd(
+            _mm256_mul_pd(_mm256_mul_pd(b, _mm256_sub_pd(vov, d)), clm),
+            _mm256_mul_pd(_mm256_mul_pd(b, core), lam));
+        __m256d idSat = _mm256_mul_pd(halfBetaVov2, clm);
+        __m256d gmSat = _mm256_mul_pd(_mm256_mul_pd(b, vov), clm);
+        __m256d gdsSat = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(half, b), lam), vov), vov);
+
+        __m256d cutoff = _mm256_cmp_pd(g, vth, _CMP_LT_OQ);
+        __m256d triode = _mm256_cmp_pd(d, vov, _CMP_LT_OQ);
+
+        _mm256_storeu_pd(id + i, _mm256_blendv_pd(_mm256_blendv_pd(idSat, idTriode, triode), zero, cutoff));
+        _mm256_storeu_pd(gm + i, _mm256_blendv_pd(_mm256_blendv_pd(gmSat, gmTriode, triode), zero, cutoff));
+        _mm256_storeu_pd(gds + i, _mm256_blendv_pd(_mm256_blendv_pd(gdsSat, gdsTriode, triode), leak, cutoff));
+    }
+#endif
+    for (; i < count; i++) {
+        mosfetLane(vgs[i], vds[i], beta[i], Vth[i], lambda[i], id[i], gm[i], gds[i]);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef DEVICE_KERNELS_H
+#define DEVICE_KERNELS_H
+
+#include <cstddef>
+
+// Batched device model kernels over structure-of-arrays inputs.
+//
+// Every kernel evaluates all count devices with no data-dependent branches:
+// both sides of each model region are computed and merged with masks, so
+// the loops map onto SIMD lanes. With AVX2 available at compile time
+// (SPICE_NATIVE_ARCH, or -mavx2) four devices are evaluated per iteration
+// with intrinsics; otherwise the same branch-free code runs one lane at a
+// time and is left to the compiler's auto-vectorizer.
+
+// y[i] = exp(x[i]). Range-reduced rational approximation, within 2 ulp of
+// std::exp; overflows to +inf above 709.78 and underflows to 0 below -745.
+void batchExp(std::size_t count, const double* x, double* y);
+
+// Shockley diode: I = Is (exp(V / nVt) - 1), G = dI/dV. Below reverseLimit
+// the diode is off: I = -Is, G = 1e-12. Same model as Diode::evaluate.
+void evaluateDiodes(std::size_t count, const double* v,
+                    const double* Is, const double* nVt, const double* reverseLimit,
+                    double* current, double* conductance);
+
+// Square-law MOSFET with channel-length modulation: drain current and its
+// derivatives gm = dId/dVgs and gds = dId/dVds, with cutoff, triode and
+// saturation regions. Same model as NMOSFET::evaluate (and PMOSFET::evaluate
+// with source-referenced voltages).
+void evaluateMOSFETs(std::size_t count, const double* vgs, const double* vds,
+                     const double* beta, const double* Vth, const double* lambda,
+                     double* id, double* gm, double* gds);
+
+#endif
@@ -0,0 +1,345 @@
+#include "device_stamper.h"
+#include "util/log.h"
+
+void DeviceStamper::compile(const DeviceSet& deviceSet, StampMode stampMode, double step) {
+    devices = &deviceSet;
+    mode = stampMode;
+    stepTime = step;
+    table.clear();
+
+    capacitorCurrent = inductorCurrent = -1;
+    diodeConductance = diodeCurrent = -1;
+    nmosGm = nmosGds = nmosCurrent = -1;
+    pmosGm = pmosGds = pmosCurrent = -1;
+
+    int numDiodes = static_cast<int>(devices->diodes.size());
+    int numNMOS = static_cast<int>(devices->nmos.size());
+    int numPMOS = static_cast<int>(devices->pmos.size());
+
+    if (mode == StampMode::DC) {
+        // Piecewise linear diode model, assuming forward bias with a 0.7V
+        // drop and a 1k ohm forward resistance. A real DC solution needs
+        // Newton-Raphson.
+        double forward_conductance = 1e-3;
+        double voltage_drop = 0.7;
+        diodeConductance = table.addCoefficients(numDiodes, forward_conductance);
+        diodeCurrent = table.addCoefficients(numDiodes, forward_conductance * voltage_drop);
+    } else if (mode == StampMode::TRANSIENT_STEP) {
+        capacitorCurrent = table.addCoefficients(static_cast<int>(devices->capacitors.size()));
+        inductorCurrent = table.addCoefficients(static_cast<int>(devices->inductors.size()));
+        diodeConductance = table.addCoefficients(numDiodes);
+        diodeCurrent = table.addCoefficients(numDiodes);
+        nmosGm = table.addCoefficients(numNMOS);
+        nmosGds = table.addCoefficients(numNMOS);
+        nmosCurrent = table.addCoefficients(numNMOS);
+        pmosGm = table.addCoefficients(numPMOS);
+        pmosGds = table.addCoefficients(numPMOS);
+        pmosCurrent = table.addCoefficients(numPMOS);
+
+        diodeVoltage.resize(numDiodes);
+        diodeI.resize(numDiodes);
+        diodeG.resize(numDiodes);
+        nmosVgs.resize(numNMOS);
+        nmosVds.resize(numNMOS);
+        nmosId.resize(numNMOS);
+        nmosGmValue.resize(numNMOS);
+        nmosGdsValue.resize(numNMOS);
+        pmosVsg.resize(numPMOS);
+        pmosVsd.resize(numPMOS);
+        pmosId.resize(numPMOS);
+        pmosGmValue.resize(numPMOS);
+        pmosGdsValue.resize(numPMOS);
+        inductorI.assign(devices->inductors.size(), 0.0);
+        inductorHistoryStarted = false;
+    }
+
+    for (const auto& entry : devices->order) {
+        int index = entry.second;
+        switch (entry.first) {
+            case DeviceSet::Kind::RESISTOR:
+                compileResistor(index);
+                break;
+            case DeviceSet::Kind::VOLTAGE_SOURCE:
+                compileVoltageSource(index);
+                break;
+            case DeviceSet::Kind::CAPACITOR:
+                compileCapacitor(index);
+                break;
+            case DeviceSet::Kind::INDUCTOR:
+                compileInductor(index);
+                break;
+            case DeviceSet::Kind::DIODE:
+                compileDiode(index);
+                break;
+            case DeviceSet::Kind::NMOS:
+                compileNMOS(index);
+                break;
+            case DeviceSet::Kind::PMOS:
+                compilePMOS(index);
+                break;
+            case DeviceSet::Kind::UNKNOWN:
+                if (mode == StampMode::DC) {
+                    SPICE_LOG_WARN(DC, "Unknown element type: " << devices->unknown[index]);
+                }
+                break;
+        }
+    }
+}
+
+void DeviceStamper::compileResistor(int index) {
+    const ResistorBank& r = devices->resistors;
+    if (mode == StampMode::DC) {
+        SPICE_LOG_DEBUG(Device, "Adding resistor " << r.name[index] << ", G=" << r.conductance[index] << " S");
+    }
+    table.addConductance(r.row1[index], r.row2[index], table.addCoefficient(r.conductance[index]));
+}
+
+void DeviceStamper::compileVoltageSource(int index) {
+    const VoltageSourceBank& v = devices->voltageSources;
+    int branch = v.branch[index];
+    if (mode == StampMode::DC) {
+        SPICE_LOG_DEBUG(Device, "Adding voltage source " << v.name[index] << ": V=" << v.voltage[index]
+                        << " V, index=" << branch);
+    }
+
+    // For voltage source from n1 to n2, the voltage constraint is: V(n1) - V(n2) = voltage
+    // Current flows out of the positive node and into the negative node
+    int unit = table.addCoefficient(1.0);
+    table.addMatrixEntry(v.row1[index], branch, unit, 1.0);
+    table.addMatrixEntry(branch, v.row1[index], unit, 1.0);
+    table.addMatrixEntry(v.row2[index], branch, unit, -1.0);
+    table.addMatrixEntry(branch, v.row2[index], unit, -1.0);
+
+    // For now, assume DC. Later add time-dependent sources
+    table.addRHSEntry(branch, table.addCoefficient(v.voltage[index]));
+}
+
+void DeviceStamper::compileCapacitor(int index) {
+    const CapacitorBank& c = devices->capacitors;
+
+    if (mode == StampMode::DC) {
+        // For DC analysis, capacitors are open circuits
+        SPICE_LOG_DEBUG(Device, "Capacitor " << c.name[index] << " ignored in DC analysis (open circuit)");
+        return;
+    }
+    if (mode != StampMode::TRANSIENT_STEP) return;
+
+    // Backward Euler: C * dv/dt ≈ C * (v_current - v_previous) / dt
+    // This creates an equivalent conductance: Geq = C/dt
+    // And an equivalent current source: Ieq = Geq * v_previous
+    double equiv_conductance = c.capacitance[index] / stepTime;
+
+    table.addConductance(c.row1[index], c.row2[index], table.addCoefficient(equiv_conductance));
+    // i = Geq * v - Ieq, so the history source drives Ieq from n2 into n1
+    table.addCurrent(c.row2[index], c.row1[index], capacitorCurrent + index);
+}
+
+void DeviceStamper::compileInductor(int index) {
+    const InductorBank& l = devices->inductors;
+
+    if (mode == StampMode::DC) {
+        // For DC analysis, inductors are short circuits: a very large
+        // conductance (1 micro-ohm resistance)
+        SPICE_LOG_DEBUG(Device, "Inductor " << l.name[index] << " treated as short circuit in DC analysis");
+        table.addConductance(l.row1[index], l.row2[index], table.addCoefficient(1e6));
+        return;
+    }
+    if (mode != StampMode::TRANSIENT_STEP) return;
+
+    // Backward Euler: L * di/dt ≈ L * (i_current - i_previous) / dt
+    // This creates voltage equation: V = L * (i_current - i_previous) / dt
+    // Rearranging: i_current = (V * dt / L) + i_previous
+    // This is equivalent to a conductance G = dt/L in parallel with a
+    // current source i_previous
+    double equiv_conductance = stepTime / l.inductance[index];
+
+    SPICE_LOG_DEBUG(Device, "Inductor " << l.name[index] << ": Geq=" << equiv_conductance << " S");
+
+    table.addConductance(l.row1[index], l.row2[index], table.addCoefficient(equiv_conductance));
+    // Current source to maintain continuity, entering n1
+    table.addCurrent(l.row1[index], l.row2[index], inductorCurrent + index);
+}
+
+void DeviceStamper::compileDiode(int index) {
+    const DiodeBank& d = devices->diodes;
+
+    if (mode == StampMode::DC) {
+        SPICE_LOG_DEBUG(Device, "Diode " << d.name[index] << " using piecewise linear model");
+    } else if (mode != StampMode::TRANSIENT_STEP) {
+        return;
+    }
+
+    // Stamp conductance and current source
+    table.addConductance(d.anode[index], d.cathode[index], diodeConductance + index);
+    table.addCurrent(d.anode[index], d.cathode[index], diodeCurrent + index);
+}
+
+void DeviceStamper::compileNMOS(int index) {
+    const MOSFETBank& m = devices->nmos;
+    int d = m.drain[index];
+    int g = m.gate[index];
+    int s = m.source[index];
+
+    if (mode == StampMode::DC) {
+        // Linear small-signal model at an assumed saturation bias; a real
+        // implementation would need Newton-Raphson
+        double Vgs_guess = 2.0;
+        double Vds_guess = 2.0;
+        double id, gm, gds;
+        m.evaluate(index, Vgs_guess, Vds_guess, id, gm, gds);
+
+        SPICE_LOG_DEBUG(Device, "NMOSFET " << m.name[index] << " using linear small-signal model: gm="
+                        << gm << " S, gds=" << gds << " S");
+
+        // Only the output conductance (drain-source) is stamped
+        if (d >= 0 && s >= 0) {
+            table.addConductance(d, s, table.addCoefficient(gds));
+        }
+        return;
+    }
+    if (mode != StampMode::TRANSIENT_STEP) return;
+
+    int gm = nmosGm + index;
+
+    // Stamp transconductance (gate-source to drain-source current)
+    // Id = gm * Vgs, so drain gets +gm*Vg - gm*Vs, source gets opposite
+    if (d >= 0 && g >= 0) {
+        table.addMatrixEntry(d, g, gm, 1.0);   // gm * Vg contributes to Id
+    }
+    if (d >= 0 && s >= 0) {
+        table.addMatrixEntry(d, s, gm, -1.0);  // -gm * Vs contributes to Id
+
+        // Output conductance (drain-source); drain gets positive current,
+        // source gets negative current
+        table.addConductance(d, s, nmosGds + index);
+        table.addCurrent(d, s, nmosCurrent + index);
+    }
+
+    // Add transconductance contribution to source node
+    if (s >= 0 && g >= 0) {
+        table.addMatrixEntry(s, g, gm, -1.0);  // Source gets opposite of drain
+    }
+    if (s >= 0) {
+        table.addMatrixEntry(s, s, gm, 1.0);   // Source self-contribution
+    }
+}
+
+void DeviceStamper::compilePMOS(int index) {
+    const MOSFETBank& m = devices->pmos;
+    int d = m.drain[index];
+    int g = m.gate[index];
+    int s = m.source[index];
+
+    if (mode == StampMode::DC) {
+        // Same assumed saturation bias as NMOS, in source-referenced
+        // voltages (Vsg, Vsd)
+        double Vsg_guess = 2.0;
+        double Vsd_guess = 2.0;
+        double id, gm, gds;
+        m.evaluate(index, Vsg_guess, Vsd_guess, id, gm, gds);
+
+        SPICE_LOG_DEBUG(Device, "PMOSFET " << m.name[index] << " using linear small-signal model: gm="
+                        << gm << " S, gds=" << gds << " S");
+
+        table.addConductance(s, d, table.addCoefficient(gds));
+        return;
+    }
+    if (mode != StampMode::TRANSIENT_STEP) return;
+
+    // Isd = gm * Vsg + gds * Vsd + Is flows from source to drain. With
+    // Vsg = Vs - Vg the transconductance terms land where NMOS puts them:
+    // source row +gm*Vs - gm*Vg, drain row the opposite
+    int gm = pmosGm + index;
+    table.addMatrixEntry(s, s, gm, 1.0);
+    table.addMatrixEntry(s, g, gm, -1.0);
+    table.addMatrixEntry(d, s, gm, -1.0);
+    table.addMatrixEntry(d, g, gm, 1.0);
+
+    table.addConductance(s, d, pmosGds + index);
+    table.addCurrent(s, d, pmosCurrent + index);
+}
+
+void DeviceStamper::updateCompanionSources(const std::vector<double>& xPrev) {
+    if (mode != StampMode::TRANSIENT_STEP) return;
+
+    // Backward Euler: Ieq = (C / dt) * v_previous
+    const CapacitorBank& c = devices->capacitors;
+    double* ieq = table.coefficients(capacitorCurrent);
+    for (size_t i = 0; i < c.size(); i++) {
+        double v_cap_prev = rowValue(xPrev, c.row1[i]) - rowValue(xPrev, c.row2[i]);
+        ieq[i] = (c.capacitance[i] / stepTime) * v_cap_prev;
+    }
+
+    // Inductor current through the step just solved: i = i_previous + (dt / L) * v
+    const InductorBank& l = devices->inductors;
+    double* iprev = table.coefficients(inductorCurrent);
+    for (size_t i = 0; i < l.size(); i++) {
+        if (inductorHistoryStarted) {
+            double v_ind_prev = rowValue(xPrev, l.row1[i]) - rowValue(xPrev, l.row2[i]);
+            inductorI[i] += (stepTime / l.inductance[i]) * v_ind_prev;
+        }
+        iprev[i] = inductorI[i];
+    }
+    inductorHistoryStarted = true;
+}
+
+void DeviceStamper::updateLinearizations(const std::vector<double>& xPrev) {
+    if (mode != StampMode::TRANSIENT_STEP) return;
+
+    // Linearize diodes around the previous operating point
+    const DiodeBank& d = devices->diodes;
+    for (size_t i = 0; i < d.size(); i++) {
+        diodeVoltage[i] = rowValue(xPrev, d.anode[i]) - rowValue(xPrev, d.cathode[i]);
+    }
+    d.evaluate(diodeVoltage.data(), diodeI.data(), diodeG.data());
+
+    double* dg = table.coefficients(diodeConductance);
+    double* dis = table.coefficients(diodeCurrent);
+    for (size_t i = 0; i < d.size(); i++) {
+        dg[i] = diodeG[i];
+        dis[i] = diodeI[i] - diodeG[i] * diodeVoltage[i];
+        SPICE_TRACE(Device, "Diode " << d.name[i] << " linearized: G=" << dg[i]
+                    << " S, Is=" << dis[i] << " A");
+    }
+
+    // Small-signal parameters of every NMOS at its previous operating point
+    const MOSFETBank& m = devices->nmos;
+    for (size_t i = 0; i < m.size(); i++) {
+        double vs_prev = rowValue(xPrev, m.source[i]);
+        nmosVgs[i] = rowValue(xPrev, m.gate[i]) - vs_prev;
+        nmosVds[i] = rowValue(xPrev, m.drain[i]) - vs_prev;
+    }
+    m.evaluate(nmosVgs.data(), nmosVds.data(), nmosId.data(), nmosGmValue.data(), nmosGdsValue.data());
+
+    double* mgm = table.coefficients(nmosGm);
+    double* mgds = table.coefficients(nmosGds);
+    double* mis = table.coefficients(nmosCurrent);
+    for (size_t i = 0; i < m.size(); i++) {
+        // Current source for linearization: Is = Id - gm*Vgs - gds*Vds
+        mgm[i] = nmosGmValue[i];
+        mgds[i] = nmosGdsValue[i];
+        mis[i] = nmosId[i] - nmosGmValue[i] * nmosVgs[i] - nmosGdsValue[i] * nmosVds[i];
+        SPICE_TRACE(Device, "NMOSFET " << m.name[i] << " linearized: gm=" << mgm[i]
+                    << " S, gds=" << mgds[i] << " S, Is=" << mis[i] << " A");
+    }
+
+    // PMOS in source-referenced voltages: Is = Isd - gm*Vsg - gds*Vsd
+    const MOSFETBank& p = devices->pmos;
+    for (size_t i = 0; i < p.size(); i++) {
+        double vs_prev = rowValue(xPrev, p.source[i]);
+        pmosVsg[i] = vs_prev - rowValue(xPrev, p.gate[i]);
+        pmosVsd[i] = vs_prev - rowValue(xPrev, p.drain[i]);
+    }
+    p.evaluate(pmosVsg.data(), pmosVsd.data(), pmosId.data(), pmosGmValue.data(), pmosGdsValue.data());
+
+    double* pgm = table.coefficients(pmosGm);
+    double* pgds = table.coefficients(pmosGds);
+    double* pis = table.coefficients(pmosCurrent);
+    for (size_t i = 0; i < p.size(); i++) {
+        pgm[i] = pmosGmValue[i];
+        pgds[i] = pmosGdsValue[i];
+        pis[i] = pmosId[i] - pmosGmValue[i] * pmosVsg[i] - pmosGdsValue[i] * pmosVsd[i];
+        SPICE_TRACE(Device, "PMOSFET " << p.name[i] << " linearized: gm=" << pgm[i]
+                    << " S, gds=" << pgds[i] << " S, Is=" << pis[i] << " A");
+    }
+}
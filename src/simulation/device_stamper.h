@@ -0,0 +1,83 @@
+#ifndef DEVICE_STAMPER_H
+#define DEVICE_STAMPER_H
+
+#include <vector>
+#include "simulation/device_banks.h"
+#include "simulation/stamp_table.h"
+
+// Analyses a device set can be stamped for
+enum class StampMode {
+    DC,                 // Operating point: C open, L short, piecewise-linear diode
+    TRANSIENT_INITIAL,  // Transient start-up: resistors and sources only
+    TRANSIENT_STEP      // Backward Euler companion models, devices linearized
+                        // around the previous time point
+};
+
+// Stamps a DeviceSet into a StampTable for one analysis mode, and refreshes
+// the coefficients that change between solves. Every analysis goes through
+// this class, so each device model is written once.
+class DeviceStamper {
+private:
+    const DeviceSet* devices = nullptr;
+    StampMode mode = StampMode::DC;
+    double stepTime = 0.0;
+    StampTable table;
+
+    // First coefficient id of each per-bank block (-1 if not stamped).
+    // Device i of a bank uses block + i, so updates are bulk array writes.
+    int capacitorCurrent = -1;
+    int inductorCurrent = -1;
+    int diodeConductance = -1;
+    int diodeCurrent = -1;
+    int nmosGm = -1;
+    int nmosGds = -1;
+    int nmosCurrent = -1;
+    int pmosGm = -1;
+    int pmosGds = -1;
+    int pmosCurrent = -1;
+
+    // Inductor branch currents at the previous time point. Inductors are
+    // open for the initial conditions, so they start from zero.
+    std::vector<double> inductorI;
+    bool inductorHistoryStarted = false;
+
+    // Evaluation workspace
+    std::vector<double> diodeVoltage, diodeI, diodeG;
+    std::vector<double> nmosVgs, nmosVds, nmosId, nmosGmValue, nmosGdsValue;
+    std::vector<double> pmosVsg, pmosVsd, pmosId, pmosGmValue, pmosGdsValue;
+
+    void compileResistor(int index);
+    void compileVoltageSource(int index);
+    void compileCapacitor(int index);
+    void compileInductor(int index);
+    void compileDiode(int index);
+    void compileNMOS(int index);
+    void compilePMOS(int index);
+
+    static double rowValue(const std::vector<double>& x, int row) {
+        return row < 0 ? 0.0 : x[row];
+    }
+
+public:
+    // Register the stamps of every device for the given mode. The device set
+    // must outlive the stamper.
+    void compile(const DeviceSet& devices, StampMode mode, double stepTime = 0.0);
+
+    // Companion-model history terms (capacitors, inductors) from the
+    // previous solution. Called once per time step, in order: each call
+    // advances the inductor currents by the step xPrev solved.
+    void updateCompanionSources(const std::vector<double>& xPrev);
+    // Linearize nonlinear devices around the previous solution
+    void updateLinearizations(const std::vector<double>& xPrev);
+
+    // Write the current coefficients into G and b
+    void assemble(SparseMatrix& G, std::vector<double>& b) {
+        table.assemble(G);
+        table.assembleRHS(b);
+    }
+    void assembleRHS(std::vector<double>& b) const { table.assembleRHS(b); }
+
+    const StampTable& stamps() const { return table; }
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "linear_solver.h"
+
+bool LinearSolver::factorize(const SparseMatrix& A) {
+    usingDense = A.size() < denseThreshold;
+    if (usingDense) {
+        if (denseOrderSize != A.size() || denseOrderVersion != A.patternVersion() ||
+            denseOrdering != sparse.getOrdering()) {
+            denseOrder = computeOrdering(A, sparse.getOrdering());
+            denseOrdering = sparse.getOrdering();
+            denseOrderVersion = A.patternVersion();
+            denseOrderSize = A.size();
+        }
+        return dense.factor(A, denseOrder);
+    }
+    return sparse.factorize(A);
+}
+
+long long LinearSolver::factorNonZeros() const {
+    if (usingDense) {
+        return static_cast<long long>(dense.size()) * dense.size();
+    }
+    // L stores its unit diagonal explicitly
+    return static_cast<long long>(sparse.nonZerosL()) + sparse.nonZerosU() - sparse.size();
+}
+
+void LinearSolver::solve(const std::vector<double>& b, std::vector<double>& x) {
+    if (usingDense) {
+        dense.solve(b, x);
+    } else {
+        sparse.solve(b, x);
+    }
+}
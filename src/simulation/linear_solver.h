@@ -0,0 +1,46 @@
+#ifndef LINEAR_SOLVER_H
+#define LINEAR_SOLVER_H
+
+#include <vector>
+#include "simulation/sparse_matrix.h"
+#include "simulation/sparse_lu.h"
+#include "simulation/dense_matrix.h"
+
+// Solver front end used by the analyses. Small systems go through the dense
+// blocked LU, where the contiguous kernel beats sparse bookkeeping; larger
+// ones go through the sparse LU with symbolic reuse. Both eliminate the
+// columns in the same fill-reducing order and share one pivot test, so a
+// circuit that solves on one side of the threshold solves on the other.
+class LinearSolver {
+private:
+    SparseLU sparse;
+    DenseLU dense;
+    int denseThreshold = defaultDenseThreshold;
+    bool usingDense = false;
+
+    // Column order of the dense path, recomputed when the pattern changes
+    std::vector<int> denseOrder;
+    OrderingMethod denseOrdering = OrderingMethod::NATURAL;
+    unsigned denseOrderVersion = 0;
+    int denseOrderSize = -1;
+
+public:
+    // Matrices with fewer rows than this are solved densely
+    static constexpr int defaultDenseThreshold = 32;
+
+    bool factorize(const SparseMatrix& A);
+    void solve(const std::vector<double>& b, std::vector<double>& x);
+
+    void setDenseThreshold(int size) { denseThreshold = size; }
+    int getDenseThreshold() const { return denseThreshold; }
+    bool isDense() const { return usingDense; }
+
+    void setOrdering(OrderingMethod method) { sparse.setOrdering(method); }
+    const OrderingStats& orderingStats() const { return sparse.orderingStats(); }
+    int nonZerosL() const { return sparse.nonZerosL(); }
+    int nonZerosU() const { return sparse.nonZerosU(); }
+    // Stored factor entries, diagonal counted once (n^2 on the dense path)
+    long long factorNonZeros() const;
+};
+
+#endif
@@ -0,0 +1,431 @@
+#include "ordering.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+// Pattern of A + A^T without the diagonal, in CSR form
+struct Graph {
+    int n = 0;
+    std::vector<int> ptr;
+    std::vector<int> adj;
+
+    int degree(int i) const { return ptr[i + 1] - ptr[i]; }
+};
+
+Graph symmetricGraph(const SparseMatrix& A) {
+    Graph g;
+    g.n = A.size();
+    const auto& rowPtr = A.rowPointers();
+    const auto& colIdx = A.colIndices();
+
+    std::vector<int> count(g.n, 0);
+    for (int row = 0; row < g.n; row++) {
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            int col = colIdx[p];
+            if (col == row) continue;
+            count[row]++;
+            count[col]++;
+        }
+    }
+
+    std::vector<int> ptr(g.n + 1, 0);
+    for (int i = 0; i < g.n; i++) {
+        ptr[i + 1] = ptr[i] + count[i];
+    }
+    std::vector<int> adj(ptr[g.n]);
+    std::vector<int> next(ptr.begin(), ptr.end() - 1);
+    for (int row = 0; row < g.n; row++) {
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            int col = colIdx[p];
+            if (col == row) continue;
+            adj[next[row]++] = col;
+            adj[next[col]++] = row;
+        }
+    }
+
+    // Symmetric entries show up twice; sort and drop duplicates
+    g.ptr.assign(g.n + 1, 0);
+    g.adj.reserve(adj.size());
+    for (int i = 0; i < g.n; i++) {
+        auto begin = adj.begin() + ptr[i];
+        auto end = adj.begin() + ptr[i + 1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        g.adj.insert(g.adj.end(), begin, end);
+        g.ptr[i + 1] = static_cast<int>(g.adj.size());
+    }
+    return g;
+}
+
+// Approximate minimum degree on a quotient graph. Variables are 0..n-1;
+// eliminated variables become elements with the same id. Extra elements
+// (ids n..n+m-1) can be supplied up front, which is how COLAMD treats the
+// rows of A: eliminating columns of A is minimum degree on A^T A, whose
+// cliques are exactly the rows.
+class MinimumDegree {
+public:
+    std::vector<std::vector<int>> varAdj;    // variable -> variables
+    std::vector<std::vector<int>> varElems;  // variable -> elements
+    std::vector<std::vector<int>> elemVars;  // element  -> variables (Le)
+
+    MinimumDegree(int numVars, int numExtraElements)
+        : varAdj(numVars), varElems(numVars), elemVars(numVars + numExtraElements),
+          n(numVars) {}
+
+    std::vector<int> run();
+
+private:
+    enum : char { VARIABLE, ELEMENT, ABSORBED };
+
+    int n;
+    std::vector<char> status;
+    std::vector<int> degree;
+    std::vector<int> head, next, prev;
+    int minDegree = 0;
+
+    void insert(int i, int d) {
+        degree[i] = d;
+        prev[i] = -1;
+        next[i] = head[d];
+        if (head[d] >= 0) prev[head[d]] = i;
+        head[d] = i;
+        if (d < minDegree) minDegree = d;
+    }
+
+    void remove(int i) {
+        if (prev[i] >= 0) next[prev[i]] = next[i];
+        else head[degree[i]] = next[i];
+        if (next[i] >= 0) prev[next[i]] = prev[i];
+    }
+
+    template <typename T>
+    static void release(std::vector<T>& v) {
+        std::vector<T>().swap(v);
+    }
+};
+
+std::vector<int> MinimumDegree::run() {
+    int total = static_cast<int>(elemVars.size());
+    status.assign(total, ELEMENT);
+    std::fill(status.begin(), status.begin() + n, VARIABLE);
+    degree.assign(n, 0);
+    head.assign(n + 1, -1);
+    next.assign(n, -1);
+    prev.assign(n, -1);
+    minDegree = n;
+
+    for (int i = 0; i < n; i++) {
+        long long d = static_cast<long long>(varAdj[i].size());
+        for (int e : varElems[i]) {
+            d += static_cast<long long>(elemVars[e].size()) - 1;
+        }
+        insert(i, static_cast<int>(std::min<long long>(d, std::max(n - 1, 0))));
+    }
+
+    std::vector<int> marker(total, 0);
+    std::vector<int> wstamp(total, 0);
+    std::vector<int> wval(total, 0);
+    int stamp = 0;
+
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<int> Lp;
+
+    for (int k = 0; k < n; k++) {
+        while (head[minDegree] < 0) minDegree++;
+        int p = head[minDegree];
+        remove(p);
+        order.push_back(p);
+
+        // Lp = variables adjacent to p, directly or through its elements
+        stamp++;
+        marker[p] = stamp;
+        Lp.clear();
+        for (int v : varAdj[p]) {
+            if (status[v] == VARIABLE && marker[v] != stamp) {
+                marker[v] = stamp;
+                Lp.push_back(v);
+            }
+        }
+        for (int e : varElems[p]) {
+            if (status[e] != ELEMENT) continue;
+            for (int v : elemVars[e]) {
+                if (status[v] == VARIABLE && marker[v] != stamp) {
+                    marker[v] = stamp;
+                    Lp.push_back(v);
+                }
+            }
+            status[e] = ABSORBED;
+            release(elemVars[e]);
+        }
+        status[p] = ELEMENT;
+        elemVars[p] = Lp;
+        release(varAdj[p]);
+        release(varElems[p]);
+
+        // Element p now covers every edge inside Lp
+        for (int i : Lp) {
+            remove(i);
+
+            auto& elems = varElems[i];
+            elems.erase(std::remove_if(elems.begin(), elems.end(),
+                        [&](int e) { return status[e] != ELEMENT; }), elems.end());
+            elems.push_back(p);
+
+            auto& vars = varAdj[i];
+            vars.erase(std::remove_if(vars.begin(), vars.end(),
+                       [&](int v) { return status[v] != VARIABLE || marker[v] == stamp; }), vars.end());
+        }
+
+        // w(e) = |Le \ Lp| for every other element touching Lp
+        for (int i : Lp) {
+            for (int e : varElems[i]) {
+                if (e == p) continue;
+                if (wstamp[e] != stamp) {
+                    wstamp[e] = stamp;
+                    wval[e] = static_cast<int>(elemVars[e].size());
+                }
+                wval[e]--;
+            }
+        }
+
+        int lpSize = static_cast<int>(Lp.size());
+        int remaining = n - k - 1;
+        for (int i : Lp) {
+            long long d = static_cast<long long>(varAdj[i].size()) + lpSize - 1;
+            auto& elems = varElems[i];
+            size_t keep = 0;
+            for (size_t j = 0; j < elems.size(); j++) {
+                int e = elems[j];
+                if (e != p) {
+                    if (status[e] != ELEMENT) continue;
+                    if (wval[e] == 0) {
+                        // Le is a subset of Lp: absorb e into p
+                        status[e] = ABSORBED;
+                        release(elemVars[e]);
+                        continue;
+                    }
+                    d += wval[e];
+                }
+                elems[keep++] = e;
+            }
+            elems.resize(keep);
+
+            d = std::min<long long>(d, static_cast<long long>(degree[i]) + lpSize - 1);
+            d = std::min<long long>(d, std::max(remaining - 1, 0));
+            insert(i, static_cast<int>(std::max<long long>(d, 0)));
+        }
+    }
+    return order;
+}
+
+std::vector<int> amdOrdering(const SparseMatrix& A) {
+    Graph g = symmetricGraph(A);
+    MinimumDegree md(g.n, 0);
+    for (int i = 0; i < g.n; i++) {
+        md.varAdj[i].assign(g.adj.begin() + g.ptr[i], g.adj.begin() + g.ptr[i + 1]);
+    }
+    return md.run();
+}
+
+std::vector<int> colamdOrdering(const SparseMatrix& A) {
+    int n = A.size();
+    const auto& rowPtr = A.rowPointers();
+    const auto& colIdx = A.colIndices();
+
+    MinimumDegree md(n, n);
+    for (int row = 0; row < n; row++) {
+        auto& vars = md.elemVars[n + row];
+        vars.assign(colIdx.begin() + rowPtr[row], colIdx.begin() + rowPtr[row + 1]);
+        for (int col : vars) {
+            md.varElems[col].push_back(n + row);
+        }
+    }
+    return md.run();
+}
+
+std::vector<int> rcmOrdering(const SparseMatrix& A) {
+    Graph g = symmetricGraph(A);
+    int n = g.n;
+
+    std::vector<int> order;
+    order.reserve(n);
+    std::vector<char> visited(n, 0);
+    std::vector<int> level(n, -1);
+    std::vector<int> levelStamp(n, -1);
+    std::vector<int> queue;
+    std::vector<int> neighbors;
+    int search = 0;
+
+    // Breadth-first level structure from root within its component; returns
+    // the last level's minimum-degree node and sets depth
+    auto bfs = [&](int root, int& depth) {
+        search++;
+        queue.clear();
+        queue.push_back(root);
+        levelStamp[root] = search;
+        level[root] = 0;
+        for (size_t h = 0; h < queue.size(); h++) {
+            int v = queue[h];
+            for (int p = g.ptr[v]; p < g.ptr[v + 1]; p++) {
+                int w = g.adj[p];
+                if (levelStamp[w] == search) continue;
+                levelStamp[w] = search;
+                level[w] = level[v] + 1;
+                queue.push_back(w);
+            }
+        }
+        depth = level[queue.back()];
+        int best = queue.back();
+        for (int v : queue) {
+            if (level[v] == depth && g.degree(v) < g.degree(best)) best = v;
+        }
+        return best;
+    };
+
+    for (int seed = 0; seed < n; seed++) {
+        if (visited[seed]) continue;
+
+        // Lowest-degree node of this component, then walk towards a
+        // pseudo-peripheral node
+        int root = seed;
+        int depth = 0;
+        bfs(seed, depth);
+        for (int v : queue) {
+            if (g.degree(v) < g.degree(root)) root = v;
+        }
+        for (int iter = 0; iter < 8; iter++) {
+            int newDepth = 0;
+            int candidate = bfs(root, newDepth);
+            if (iter > 0 && newDepth <= depth) break;
+            depth = newDepth;
+            root = candidate;
+        }
+
+        // Cuthill-McKee: neighbors visited in increasing degree order
+        size_t start = order.size();
+        order.push_back(root);
+        visited[root] = 1;
+        for (size_t h = start; h < order.size(); h++) {
+            int v = order[h];
+            neighbors.clear();
+            for (int p = g.ptr[v]; p < g.ptr[v + 1]; p++) {
+                int w = g.adj[p];
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    neighbors.push_back(w);
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end(), [&](int a, int b) {
+                return g.degree(a) != g.degree(b) ? g.degree(a) < g.degree(b) : a < b;
+            });
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+} // namespace
+
+const char* orderingName(OrderingMethod method) {
+    switch (method) {
+        case OrderingMethod::NATURAL: return "natural";
+        case OrderingMethod::AMD:     return "amd";
+        case OrderingMethod::COLAMD:  return "colamd";
+        case OrderingMethod::RCM:     return "rcm";
+    }
+    return "unknown";
+}
+
+bool parseOrderingMethod(const std::string& name, OrderingMethod& method) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    for (OrderingMethod m : {OrderingMethod::NATURAL, OrderingMethod::AMD,
+                             OrderingMethod::COLAMD, OrderingMethod::RCM}) {
+        if (lower == orderingName(m)) {
+            method = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> computeOrdering(const SparseMatrix& A, OrderingMethod method) {
+    switch (method) {
+        case OrderingMethod::AMD:    return amdOrdering(A);
+        case OrderingMethod::COLAMD: return colamdOrdering(A);
+        case OrderingMethod::RCM:    return rcmOrdering(A);
+        case OrderingMethod::NATURAL:
+            break;
+    }
+
+    std::vector<int> perm(A.size());
+    for (int i = 0; i < A.size(); i++) {
+        perm[i] = i;
+    }
+    return perm;
+}
+
+OrderingStats predictFill(const SparseMatrix& A, const std::vector<int>& perm) {
+    OrderingStats stats;
+    int n = A.size();
+    stats.matrixNonZeros = A.nonZeros();
+
+    std::vector<int> pinv(n);
+    for (int k = 0; k < n; k++) {
+        pinv[perm[k]] = k;
+    }
+
+    const auto& rowPtr = A.rowPointers();
+    const auto& colIdx = A.colIndices();
+    for (int row = 0; row < n; row++) {
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            stats.bandwidth = std::max(stats.bandwidth, std::abs(pinv[row] - pinv[colIdx[p]]));
+        }
+    }
+
+    // Elimination tree of the permuted symmetric pattern
+    Graph g = symmetricGraph(A);
+    std::vector<int> parent(n, -1);
+    std::vector<int> ancestor(n, -1);
+    for (int k = 0; k < n; k++) {
+        int v = perm[k];
+        for (int p = g.ptr[v]; p < g.ptr[v + 1]; p++) {
+            int i = pinv[g.adj[p]];
+            while (i != -1 && i < k) {
+                int inext = ancestor[i];
+                ancestor[i] = k;
+                if (inext == -1) parent[i] = k;
+                i = inext;
+            }
+        }
+    }
+
+    // Row counts of L: row k reaches every etree node on the paths from its
+    // nonzeros up to k
+    std::vector<int> mark(n, -1);
+    long long nnzL = 0;
+    for (int k = 0; k < n; k++) {
+        mark[k] = k;
+        nnzL++;
+        int v = perm[k];
+        for (int p = g.ptr[v]; p < g.ptr[v + 1]; p++) {
+            int i = pinv[g.adj[p]];
+            if (i > k) continue;
+            while (mark[i] != k) {
+                mark[i] = k;
+                nnzL++;
+                i = parent[i];
+            }
+        }
+    }
+
+    // L (unit diagonal) and U both store the diagonal in SparseLU
+    stats.predictedFactorNonZeros = 2 * nnzL;
+    stats.predictedFill = stats.predictedFactorNonZeros - stats.matrixNonZeros;
+    return stats;
+}
@@ -0,0 +1,40 @@
+#ifndef ORDERING_H
+#define ORDERING_H
+
+#include <vector>
+#include <string>
+#include "simulation/sparse_matrix.h"
+
+// Fill-reducing / bandwidth-reducing orderings applied between assembly and
+// factorization, so the factor cost does not depend on the order in which
+// nodes happen to appear in the netlist.
+enum class OrderingMethod {
+    NATURAL,  // Node numbers as parsed
+    AMD,      // Approximate minimum degree on the pattern of A + A^T
+    COLAMD,   // Approximate minimum degree on the columns of A (graph of A^T A)
+    RCM       // Reverse Cuthill-McKee (bandwidth reduction)
+};
+
+struct OrderingStats {
+    OrderingMethod method = OrderingMethod::NATURAL;
+    int matrixNonZeros = 0;
+    // Predicted nnz(L) + nnz(U) from a symbolic Cholesky of A + A^T under
+    // the ordering. Exact for diagonal pivots; pivoting away from the
+    // diagonal can add to it.
+    long long predictedFactorNonZeros = 0;
+    long long predictedFill = 0;  // predictedFactorNonZeros - nnz(A)
+    int bandwidth = 0;            // max |i - j| over nonzeros after permuting
+    double orderingSeconds = 0.0;
+};
+
+const char* orderingName(OrderingMethod method);
+bool parseOrderingMethod(const std::string& name, OrderingMethod& method);
+
+// Returns perm with perm[k] = original index eliminated at step k.
+// A must be compressed.
+std::vector<int> computeOrdering(const SparseMatrix& A, OrderingMethod method);
+
+// Symbolic fill prediction for a given elimination order
+OrderingStats predictFill(const SparseMatrix& A, const std::vector<int>& perm);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SIMULATION_PROGRESS_H
+#define SIMULATION_PROGRESS_H
+
+#include <atomic>
+
+// Live state of a running analysis. The simulation thread publishes it once
+// per time step; any other thread may read it or request cancellation.
+// Fields are independent relaxed atomics, so a reader sees recent values,
+// not one consistent snapshot.
+struct SimulationProgress {
+    std::atomic<double> time{0.0};
+    std::atomic<double> startTime{0.0};
+    std::atomic<double> stopTime{0.0};
+    std::atomic<long long> timeSteps{0};
+    std::atomic<long long> linearizations{0};
+    std::atomic<long long> rejectedSteps{0};
+    std::atomic<bool> cancelRequested{false};
+
+    void reset() {
+        time.store(0.0, std::memory_order_relaxed);
+        startTime.store(0.0, std::memory_order_relaxed);
+        stopTime.store(0.0, std::memory_order_relaxed);
+        timeSteps.store(0, std::memory_order_relaxed);
+        linearizations.store(0, std::memory_order_relaxed);
+        rejectedSteps.store(0, std::memory_order_relaxed);
+        cancelRequested.store(false, std::memory_order_relaxed);
+    }
+
+    void requestCancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelRequested.load(std::memory_order_relaxed); }
+
+    // Share of the simulated interval done so far, 0 to 1
+    double fraction() const {
+        double start = startTime.load(std::memory_order_relaxed);
+        double span = stopTime.load(std::memory_order_relaxed) - start;
+        if (span <= 0.0) return 0.0;
+        double done = (time.load(std::memory_order_relaxed) - start) / span;
+        return done < 0.0 ? 0.0 : (done > 1.0 ? 1.0 : done);
+    }
+};
+
+#endif
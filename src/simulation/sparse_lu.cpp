@@ -0,0 +1,294 @@
+#include "sparse_lu.h"
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <chrono>
+
+bool SparseLU::analyze(const SparseMatrix& A) {
+    if (!A.isCompressed()) return false;
+
+    n = A.size();
+    analyzed = false;
+    factored = false;
+
+    auto start = std::chrono::steady_clock::now();
+    q = computeOrdering(A, orderingMethod);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    ordering = predictFill(A, q);
+    ordering.method = orderingMethod;
+    ordering.orderingSeconds = elapsed.count();
+
+    // Build the CSC pattern and the CSR -> CSC slot map
+    const auto& rowPtr = A.rowPointers();
+    const auto& colIdx = A.colIndices();
+    int nnz = A.nonZeros();
+
+    Ap.assign(n + 1, 0);
+    for (int p = 0; p < nnz; p++) {
+        Ap[colIdx[p] + 1]++;
+    }
+    for (int col = 0; col < n; col++) {
+        Ap[col + 1] += Ap[col];
+    }
+
+    std::vector<int> next(Ap.begin(), Ap.end() - 1);
+    Ai.resize(nnz);
+    Ax.resize(nnz);
+    cscSlot.resize(nnz);
+    for (int row = 0; row < n; row++) {
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            int dest = next[colIdx[p]]++;
+            Ai[dest] = row;
+            cscSlot[p] = dest;
+        }
+    }
+
+    work.assign(n, 0.0);
+    solveWork.assign(n, 0.0);
+    xi.assign(n, 0);
+    nodeStack.assign(n, 0);
+    posStack.assign(n, 0);
+    mark.assign(n, 0);
+    markStamp = 0;
+
+    analyzedVersion = A.patternVersion();
+    analyzed = true;
+    return true;
+}
+
+void SparseLU::loadValues(const SparseMatrix& A) {
+    const auto& vals = A.values();
+    for (size_t p = 0; p < vals.size(); p++) {
+        Ax[cscSlot[p]] = vals[p];
+    }
+    A.magnitudes(rowScale, colScale);
+}
+
+// Rows reachable from A(:,col) in the graph of the L columns computed so far,
+// returned in xi[top..n-1] in topological order
+int SparseLU::reach(int col) {
+    if (markStamp == INT_MAX) {
+        std::fill(mark.begin(), mark.end(), 0);
+        markStamp = 0;
+    }
+    markStamp++;
+
+    int top = n;
+    for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+        int start = Ai[p];
+        if (mark[start] == markStamp) continue;
+
+        int head = 0;
+        nodeStack[0] = start;
+        while (head >= 0) {
+            int j = nodeStack[head];
+            int J = pinv[j];
+            if (mark[j] != markStamp) {
+                mark[j] = markStamp;
+                posStack[head] = (J < 0) ? 0 : Lp[J] + 1;
+            }
+
+            bool done = true;
+            int end = (J < 0) ? 0 : Lp[J + 1];
+            for (int pos = posStack[head]; pos < end; pos++) {
+                int i = Li[pos];
+                if (mark[i] == markStamp) continue;
+                posStack[head] = pos + 1;
+                nodeStack[++head] = i;
+                done = false;
+                break;
+            }
+
+            if (done) {
+                head--;
+                xi[--top] = j;
+            }
+        }
+    }
+    return top;
+}
+
+bool SparseLU::factor(const SparseMatrix& A) {
+    if (needsAnalysis(A) && !analyze(A)) return false;
+
+    factored = false;
+    loadValues(A);
+
+    pinv.assign(n, -1);
+    Lp.assign(n + 1, 0);
+    Up.assign(n + 1, 0);
+    Li.clear();
+    Lx.clear();
+    Ui.clear();
+    Ux.clear();
+    std::fill(work.begin(), work.end(), 0.0);
+
+    for (int k = 0; k < n; k++) {
+        Lp[k] = static_cast<int>(Li.size());
+        Up[k] = static_cast<int>(Ui.size());
+        int col = q[k];
+
+        // Sparse triangular solve L(:,0:k-1) x = A(:,col)
+        int top = reach(col);
+        for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+            work[Ai[p]] = Ax[p];
+        }
+        for (int px = top; px < n; px++) {
+            int j = xi[px];
+            int J = pinv[j];
+            if (J < 0) continue;
+            double xj = work[j];
+            for (int p = Lp[J] + 1; p < Lp[J + 1]; p++) {
+                work[Li[p]] -= Lx[p] * xj;
+            }
+        }
+
+        // Split into the U column and the pivot candidates
+        int ipiv = -1;
+        double amax = -1.0;
+        for (int px = top; px < n; px++) {
+            int i = xi[px];
+            if (pinv[i] < 0) {
+                double a = std::abs(work[i]);
+                if (a > amax) {
+                    amax = a;
+                    ipiv = i;
+                }
+            } else {
+                Ui.push_back(pinv[i]);
+                Ux.push_back(work[i]);
+            }
+        }
+
+        if (ipiv < 0 || isNegligiblePivot(amax, rowScale[ipiv], colScale[col])) {
+            for (int px = top; px < n; px++) {
+                work[xi[px]] = 0.0;
+            }
+            return false;
+        }
+
+        // Keep the diagonal if it is good enough; this preserves the ordering
+        if (pinv[col] < 0 && std::abs(work[col]) >= pivotTolerance * amax &&
+            !isNegligiblePivot(work[col], rowScale[col], colScale[col])) {
+            ipiv = col;
+        }
+
+        double pivot = work[ipiv];
+        Ui.push_back(k);
+        Ux.push_back(pivot);
+        pinv[ipiv] = k;
+        Li.push_back(ipiv);
+        Lx.push_back(1.0);
+        for (int px = top; px < n; px++) {
+            int i = xi[px];
+            if (pinv[i] < 0) {
+                Li.push_back(i);
+                Lx.push_back(work[i] / pivot);
+            }
+            work[i] = 0.0;
+        }
+    }
+    Lp[n] = static_cast<int>(Li.size());
+    Up[n] = static_cast<int>(Ui.size());
+
+    // Relabel L rows into pivoted order
+    for (auto& row : Li) {
+        row = pinv[row];
+    }
+    prow.resize(n);
+    for (int row = 0; row < n; row++) {
+        prow[pinv[row]] = row;
+    }
+
+    factored = true;
+    return true;
+}
+
+bool SparseLU::refactor(const SparseMatrix& A) {
+    if (!factored || needsAnalysis(A)) return false;
+
+    loadValues(A);
+
+    for (int k = 0; k < n; k++) {
+        int col = q[k];
+        for (int p = Ap[col]; p < Ap[col + 1]; p++) {
+            work[pinv[Ai[p]]] = Ax[p];
+        }
+
+        // Apply previous columns in the order recorded by factor()
+        for (int p = Up[k]; p < Up[k + 1] - 1; p++) {
+            int J = Ui[p];
+            double ujk = work[J];
+            work[J] = 0.0;
+            Ux[p] = ujk;
+            for (int r = Lp[J] + 1; r < Lp[J + 1]; r++) {
+                work[Li[r]] -= Lx[r] * ujk;
+            }
+        }
+
+        double pivot = work[k];
+        work[k] = 0.0;
+
+        double amax = 0.0;
+        for (int p = Lp[k] + 1; p < Lp[k + 1]; p++) {
+            amax = std::max(amax, std::abs(work[Li[p]]));
+        }
+
+        if (isNegligiblePivot(pivot, rowScale[prow[k]], colScale[col]) || std::abs(pivot) < pivotTolerance * amax) {
+            // The stored pivot sequence is no longer stable for these values
+            for (int p = Lp[k] + 1; p < Lp[k + 1]; p++) {
+                work[Li[p]] = 0.0;
+            }
+            factored = false;
+            return false;
+        }
+
+        Ux[Up[k + 1] - 1] = pivot;
+        for (int p = Lp[k] + 1; p < Lp[k + 1]; p++) {
+            int i = Li[p];
+            Lx[p] = work[i] / pivot;
+            work[i] = 0.0;
+        }
+    }
+    return true;
+}
+
+bool SparseLU::factorize(const SparseMatrix& A) {
+    if (needsAnalysis(A)) {
+        return analyze(A) && factor(A);
+    }
+    if (factored && refactor(A)) {
+        return true;
+    }
+    return factor(A);
+}
+
+void SparseLU::solve(const std::vector<double>& b, std::vector<double>& x) {
+    std::vector<double>& y = solveWork;
+    for (int k = 0; k < n; k++) {
+        y[k] = b[prow[k]];
+    }
+
+    // L y = P b (unit diagonal stored first)
+    for (int j = 0; j < n; j++) {
+        double yj = y[j];
+        for (int p = Lp[j] + 1; p < Lp[j + 1]; p++) {
+            y[Li[p]] -= Lx[p] * yj;
+        }
+    }
+
+    // U z = y (diagonal stored last)
+    for (int j = n - 1; j >= 0; j--) {
+        y[j] /= Ux[Up[j + 1] - 1];
+        double yj = y[j];
+        for (int p = Up[j]; p < Up[j + 1] - 1; p++) {
+            y[Ui[p]] -= Ux[p] * yj;
+        }
+    }
+
+    x.resize(n);
+    for (int k = 0; k < n; k++) {
+        x[q[k]] = y[k];
+    }
+}
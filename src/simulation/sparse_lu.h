@@ -0,0 +1,99 @@
+#ifndef SPARSE_LU_H
+#define SPARSE_LU_H
+
+#include <vector>
+#include "simulation/sparse_matrix.h"
+#include "simulation/ordering.h"
+
+// Sparse LU factorization (left-looking Gilbert-Peierls with partial pivoting).
+//
+// The work is split in three stages so that repeated solves of a matrix with
+// a fixed sparsity pattern (every time step, every Newton iteration) only pay
+// for the numeric part:
+//   analyze()  - fill-reducing column ordering and CSC structure; redone
+//                only when the matrix pattern changes
+//   factor()   - full numeric factorization; picks the pivot sequence and
+//                discovers the fill pattern of L and U
+//   refactor() - numeric-only factorization reusing the pivot sequence and
+//                L/U patterns from the last factor() call
+// factorize() chooses the cheapest of the three that is valid.
+class SparseLU {
+private:
+    int n = 0;
+    unsigned analyzedVersion = 0;
+    bool analyzed = false;
+    bool factored = false;
+
+    // Column ordering (q[k] = original column eliminated at step k)
+    OrderingMethod orderingMethod = OrderingMethod::AMD;
+    OrderingStats ordering;
+    std::vector<int> q;
+
+    // CSC copy of A; cscSlot maps each CSR value slot to its CSC position
+    std::vector<int> Ap, Ai;
+    std::vector<double> Ax;
+    std::vector<int> cscSlot;
+    std::vector<double> rowScale, colScale;  // largest |A| per row and column
+
+    // Row pivots: pinv[row] = step at which row was chosen as pivot
+    std::vector<int> pinv;
+    std::vector<int> prow;
+
+    // L is unit lower triangular with the diagonal stored first in each
+    // column; U stores its diagonal last in each column. Row indices refer to
+    // pivoted (step) order.
+    std::vector<int> Lp, Li;
+    std::vector<double> Lx;
+    std::vector<int> Up, Ui;
+    std::vector<double> Ux;
+
+    // Workspace
+    std::vector<double> work;
+    std::vector<double> solveWork;
+    std::vector<int> xi;
+    std::vector<int> nodeStack;
+    std::vector<int> posStack;
+    std::vector<int> mark;
+    int markStamp = 0;
+
+    int reach(int col);
+    void loadValues(const SparseMatrix& A);
+
+public:
+    // Pivots are tested with isNegligiblePivot().
+    // Prefer the diagonal entry as pivot if it is within this fraction of the
+    // largest candidate; also the growth limit that triggers a full factor()
+    // from refactor()
+    static constexpr double pivotTolerance = 1e-3;
+
+    // A must be compressed
+    bool analyze(const SparseMatrix& A);
+    bool factor(const SparseMatrix& A);
+    bool refactor(const SparseMatrix& A);
+    bool factorize(const SparseMatrix& A);
+
+    // Solve A x = b using the current factors
+    void solve(const std::vector<double>& b, std::vector<double>& x);
+
+    bool needsAnalysis(const SparseMatrix& A) const {
+        return !analyzed || A.patternVersion() != analyzedVersion || A.size() != n;
+    }
+    bool isFactored() const { return factored; }
+
+    // Takes effect at the next analyze()
+    void setOrdering(OrderingMethod method) {
+        if (method != orderingMethod) {
+            orderingMethod = method;
+            analyzed = false;
+            factored = false;
+        }
+    }
+    OrderingMethod getOrdering() const { return orderingMethod; }
+    const OrderingStats& orderingStats() const { return ordering; }
+
+    int nonZerosL() const { return static_cast<int>(Li.size()); }
+    int nonZerosU() const { return static_cast<int>(Ui.size()); }
+    int size() const { return n; }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "sparse_matrix.h"
+#include <algorithm>
+
+SparseMatrix::SparseMatrix(int size) {
+    resize(size);
+}
+
+void SparseMatrix::resize(int size) {
+    n = size;
+    rowPtr.assign(n + 1, 0);
+    colIdx.clear();
+    vals.clear();
+    pending.clear();
+    version++;
+}
+
+void SparseMatrix::addEntry(int row, int col, double value) {
+    int slot = findSlot(row, col);
+    if (slot >= 0) {
+        vals[slot] += value;
+        return;
+    }
+    pending.push_back({row, col, value});
+}
+
+void SparseMatrix::clearValues() {
+    std::fill(vals.begin(), vals.end(), 0.0);
+    // Queued entries are kept as structural zeros so the pattern survives
+    for (auto& t : pending) {
+        t.value = 0.0;
+    }
+}
+
+void SparseMatrix::clear() {
+    resize(n);
+}
+
+void SparseMatrix::compress() {
+    if (pending.empty()) return;
+
+    std::sort(pending.begin(), pending.end(), [](const Triplet& a, const Triplet& b) {
+        return a.row != b.row ? a.row < b.row : a.col < b.col;
+    });
+
+    std::vector<int> newRowPtr(n + 1, 0);
+    std::vector<int> newColIdx;
+    std::vector<double> newVals;
+    newColIdx.reserve(colIdx.size() + pending.size());
+    newVals.reserve(vals.size() + pending.size());
+
+    // Merge the existing CSR rows with the sorted triplets row by row
+    size_t t = 0;
+    for (int row = 0; row < n; row++) {
+        int p = rowPtr[row];
+        int end = rowPtr[row + 1];
+
+        while (p < end || (t < pending.size() && pending[t].row == row)) {
+            bool takeExisting = p < end &&
+                (t >= pending.size() || pending[t].row != row || colIdx[p] <= pending[t].col);
+
+            int col;
+            double value;
+            if (takeExisting) {
+                col = colIdx[p];
+                value = vals[p];
+                p++;
+            } else {
+                col = pending[t].col;
+                value = pending[t].value;
+                t++;
+            }
+
+            if (static_cast<int>(newColIdx.size()) > newRowPtr[row] && newColIdx.back() == col) {
+                newVals.back() += value;
+            } else {
+                newColIdx.push_back(col);
+                newVals.push_back(value);
+            }
+        }
+        newRowPtr[row + 1] = static_cast<int>(newColIdx.size());
+    }
+
+    rowPtr.swap(newRowPtr);
+    colIdx.swap(newColIdx);
+    vals.swap(newVals);
+    std::vector<Triplet>().swap(pending);
+    version++;
+}
+
+int SparseMatrix::findSlot(int row, int col) const {
+    auto begin = colIdx.begin() + rowPtr[row];
+    auto end = colIdx.begin() + rowPtr[row + 1];
+    auto it = std::lower_bound(begin, end, col);
+    if (it != end && *it == col) {
+        return static_cast<int>(it - colIdx.begin());
+    }
+    return -1;
+}
+
+double SparseMatrix::get(int row, int col) const {
+    if (row < 0 || row >= n || col < 0 || col >= n) return 0.0;
+
+    double value = 0.0;
+    int slot = findSlot(row, col);
+    if (slot >= 0) value = vals[slot];
+    for (const auto& t : pending) {
+        if (t.row == row && t.col == col) value += t.value;
+    }
+    return value;
+}
+
+void SparseMatrix::magnitudes(std::vector<double>& rowScale, std::vector<double>& colScale) const {
+    rowScale.assign(n, 0.0);
+    colScale.assign(n, 0.0);
+    for (int row = 0; row < n; row++) {
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            double magnitude = std::abs(vals[p]);
+            rowScale[row] = std::max(rowScale[row], magnitude);
+            colScale[colIdx[p]] = std::max(colScale[colIdx[p]], magnitude);
+        }
+    }
+}
+
+void SparseMatrix::multiply(const std::vector<double>& x, std::vector<double>& y) const {
+    y.assign(n, 0.0);
+    for (int row = 0; row < n; row++) {
+        double sum = 0.0;
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            sum += vals[p] * x[colIdx[p]];
+        }
+        y[row] = sum;
+    }
+    for (const auto& t : pending) {
+        y[t.row] += t.value * x[t.col];
+    }
+}
+
+std::vector<std::vector<double>> SparseMatrix::toDense() const {
+    std::vector<std::vector<double>> dense(n, std::vector<double>(n, 0.0));
+    for (int row = 0; row < n; row++) {
+        for (int p = rowPtr[row]; p < rowPtr[row + 1]; p++) {
+            dense[row][colIdx[p]] += vals[p];
+        }
+    }
+    for (const auto& t : pending) {
+        dense[t.row][t.col] += t.value;
+    }
+    return dense;
+}
@@ -0,0 +1,85 @@
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Square sparse matrix used for MNA assembly.
+//
+// Entries are stamped with addEntry(). The first time a (row, col) position is
+// touched it is queued as a triplet; compress() folds the queued triplets into
+// the compressed sparse row (CSR) pattern. Once a position is part of the
+// pattern, addEntry() accumulates directly into its value slot, so re-stamping
+// the same circuit every time step never allocates and clearValues() only
+// touches the nonzeros.
+class SparseMatrix {
+private:
+    struct Triplet {
+        int row;
+        int col;
+        double value;
+    };
+
+    int n = 0;
+    std::vector<int> rowPtr;      // size n+1
+    std::vector<int> colIdx;      // size nnz, sorted within each row
+    std::vector<double> vals;     // size nnz
+    std::vector<Triplet> pending; // entries not yet in the pattern
+    unsigned version = 0;         // bumped whenever the pattern changes
+
+public:
+    explicit SparseMatrix(int size = 0);
+
+    void resize(int size);
+    int size() const { return n; }
+
+    // Accumulate value into (row, col). Indices must be in range.
+    void addEntry(int row, int col, double value);
+
+    // Zero all stored values but keep the sparsity pattern.
+    void clearValues();
+
+    // Drop values and pattern.
+    void clear();
+
+    // Merge queued triplets into the CSR pattern (duplicates are summed).
+    void compress();
+    bool isCompressed() const { return pending.empty(); }
+
+    // Index of (row, col) in values(), or -1 if not in the pattern.
+    int findSlot(int row, int col) const;
+    double get(int row, int col) const;
+
+    int nonZeros() const { return static_cast<int>(vals.size()); }
+    unsigned patternVersion() const { return version; }
+
+    const std::vector<int>& rowPointers() const { return rowPtr; }
+    const std::vector<int>& colIndices() const { return colIdx; }
+    const std::vector<double>& values() const { return vals; }
+    std::vector<double>& values() { return vals; }
+
+    // y = A * x
+    void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+
+    // Largest magnitude in every row and every column of the compressed
+    // pattern
+    void magnitudes(std::vector<double>& rowScale, std::vector<double>& colScale) const;
+
+    std::vector<std::vector<double>> toDense() const;
+};
+
+// Pivot test shared by the dense and sparse LU, so that whether a circuit
+// solves does not depend on which of them it lands in. A pivot counts as
+// zero when it is below this fraction of the largest entry of both its row
+// and its column in A. The test follows the scale of the equations: a
+// forward-biased diode's 1e71 S does not make the unit entry of a voltage
+// source look singular, while cancellation among large entries does. NaN
+// pivots count as zero too.
+constexpr double relativePivotThreshold = 1e-12;
+
+inline bool isNegligiblePivot(double pivot, double rowScale, double colScale) {
+    return !(std::abs(pivot) > relativePivotThreshold * std::min(rowScale, colScale));
+}
+
+#endif
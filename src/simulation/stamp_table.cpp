@@ -0,0 +1,101 @@
+#include "stamp_table.h"
+#include <algorithm>
+
+void StampTable::clear() {
+    coeffs.clear();
+    stampRow.clear();
+    stampCol.clear();
+    stampSlot.clear();
+    stampCoeff.clear();
+    stampScale.clear();
+    rhsRow.clear();
+    rhsCoeff.clear();
+    rhsScale.clear();
+    resolved = false;
+}
+
+int StampTable::addCoefficient(double initial) {
+    coeffs.push_back(initial);
+    return static_cast<int>(coeffs.size()) - 1;
+}
+
+int StampTable::addCoefficients(int count, double initial) {
+    int first = static_cast<int>(coeffs.size());
+    coeffs.resize(coeffs.size() + count, initial);
+    return first;
+}
+
+void StampTable::addMatrixEntry(int row, int col, int coeff, double scale) {
+    if (row < 0 || col < 0) return;
+    stampRow.push_back(row);
+    stampCol.push_back(col);
+    stampSlot.push_back(-1);
+    stampCoeff.push_back(coeff);
+    stampScale.push_back(scale);
+    resolved = false;
+}
+
+void StampTable::addRHSEntry(int row, int coeff, double scale) {
+    if (row < 0) return;
+    rhsRow.push_back(row);
+    rhsCoeff.push_back(coeff);
+    rhsScale.push_back(scale);
+}
+
+void StampTable::addConductance(int row1, int row2, int coeff) {
+    addMatrixEntry(row1, row1, coeff, 1.0);
+    addMatrixEntry(row1, row2, coeff, -1.0);
+    addMatrixEntry(row2, row2, coeff, 1.0);
+    addMatrixEntry(row2, row1, coeff, -1.0);
+}
+
+void StampTable::addCurrent(int row1, int row2, int coeff) {
+    addRHSEntry(row1, coeff, -1.0);
+    addRHSEntry(row2, coeff, 1.0);
+}
+
+void StampTable::compile(SparseMatrix& G) {
+    for (size_t k = 0; k < stampRow.size(); k++) {
+        if (G.findSlot(stampRow[k], stampCol[k]) < 0) {
+            G.addEntry(stampRow[k], stampCol[k], 0.0);
+        }
+    }
+    G.compress();
+    resolve(G);
+}
+
+void StampTable::resolve(const SparseMatrix& G) {
+    for (size_t k = 0; k < stampRow.size(); k++) {
+        stampSlot[k] = G.findSlot(stampRow[k], stampCol[k]);
+    }
+    resolvedVersion = G.patternVersion();
+    resolved = true;
+}
+
+void StampTable::assemble(SparseMatrix& G) {
+    // Another table may have grown the shared pattern since compile()
+    if (!resolved || G.patternVersion() != resolvedVersion) {
+        compile(G);
+    }
+
+    G.clearValues();
+    double* vals = G.values().data();
+    const double* c = coeffs.data();
+    const int* slot = stampSlot.data();
+    const int* coeff = stampCoeff.data();
+    const double* scale = stampScale.data();
+    size_t count = stampSlot.size();
+    for (size_t k = 0; k < count; k++) {
+        vals[slot[k]] += scale[k] * c[coeff[k]];
+    }
+}
+
+void StampTable::assembleRHS(std::vector<double>& b) const {
+    std::fill(b.begin(), b.end(), 0.0);
+    double* rhs = b.data();
+    const double* c = coeffs.data();
+    size_t count = rhsRow.size();
+    for (size_t k = 0; k < count; k++) {
+        rhs[rhsRow[k]] += rhsScale[k] * c[rhsCoeff[k]];
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef STAMP_TABLE_H
+#define STAMP_TABLE_H
+
+#include <vector>
+#include "simulation/sparse_matrix.h"
+
+// Precompiled assembly plan for an MNA system.
+//
+// During setup each element registers the matrix positions and RHS rows it
+// touches, each tied to a coefficient id (a conductance, a companion current,
+// a source value...). compile() resolves every matrix position to its value
+// slot in the SparseMatrix once. Per step, callers only update coefficient
+// values; assemble()/assembleRHS() are then flat loops of indexed adds with
+// no ground checks, bounds checks or name lookups.
+//
+// Rows are matrix rows (node - 1 or a branch index); -1 means ground and the
+// entry is dropped at registration time.
+class StampTable {
+private:
+    std::vector<double> coeffs;
+
+    // Matrix stamps (row/col kept for re-resolving slots)
+    std::vector<int> stampRow;
+    std::vector<int> stampCol;
+    std::vector<int> stampSlot;
+    std::vector<int> stampCoeff;
+    std::vector<double> stampScale;
+
+    // RHS stamps
+    std::vector<int> rhsRow;
+    std::vector<int> rhsCoeff;
+    std::vector<double> rhsScale;
+
+    unsigned resolvedVersion = 0;
+    bool resolved = false;
+
+    void resolve(const SparseMatrix& G);
+
+public:
+    void clear();
+
+    // Setup
+    int addCoefficient(double initial = 0.0);
+    // Contiguous block of count coefficients; returns the first id
+    int addCoefficients(int count, double initial = 0.0);
+    void addMatrixEntry(int row, int col, int coeff, double scale = 1.0);
+    void addRHSEntry(int row, int coeff, double scale = 1.0);
+    // Two-terminal conductance between row1 and row2
+    void addConductance(int row1, int row2, int coeff);
+    // Current coeff flowing from row1 to row2 through the element
+    void addCurrent(int row1, int row2, int coeff);
+
+    // Add the registered positions to G's pattern and resolve value slots
+    void compile(SparseMatrix& G);
+
+    // Per step
+    double& coefficient(int id) { return coeffs[id]; }
+    double coefficient(int id) const { return coeffs[id]; }
+    // Base pointer of a block from addCoefficients(), for bulk updates
+    double* coefficients(int first) { return coeffs.data() + first; }
+    void assemble(SparseMatrix& G);
+    void assembleRHS(std::vector<double>& b) const;
+
+    int matrixStampCount() const { return static_cast<int>(stampSlot.size()); }
+    int rhsStampCount() const { return static_cast<int>(rhsRow.size()); }
+};
+
+#endif
@@ -1,11 +1,25 @@
 #include "transient_analysis.h"
+#include "util/log.h"
+#include "simulation/waveform_file.h"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <cmath>
 #include <algorithm>
+#include <cctype>
 
-TransientAnalysis::TransientAnalysis(std::vector<std::unique_ptr<CircuitElement>>& elems, 
+namespace {
+
+bool sameName(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+               return std::tolower(x) == std::tolower(y);
+           });
+}
+
+} // namespace
+
+TransientAnalysis::TransientAnalysis(const std::vector<std::unique_ptr<CircuitElement>>& elems, 
                                    int nodes, const TransientSettings& settings)
     : elements(elems), numNodes(nodes), settings(settings) {
     
@@ -25,20 +39,33 @@ TransientAnalysis::TransientAnalysis(std::vector<std::unique_ptr<CircuitElement>
     matrixSize = (numNodes - 1) + numVoltageSources;
     
     // Initialize matrices
-    G.assign(matrixSize, std::vector<double>(matrixSize, 0.0));
+    G.resize(matrixSize);
     b.assign(matrixSize, 0.0);
     x.assign(matrixSize, 0.0);
     x_prev.assign(matrixSize, 0.0);
     
-    std::cout << "Transient Analysis initialized:" << std::endl;
-    std::cout << "  Time: " << settings.startTime << "s to " << settings.stopTime 
-              << "s, step: " << settings.stepTime << "s" << std::endl;
-    std::cout << "  Matrix size: " << matrixSize << "x" << matrixSize << std::endl;
-    std::cout << "  Integration method: Backward Euler" << std::endl;
+    SPICE_LOG_INFO(Transient, "Transient Analysis initialized: " << settings.startTime << "s to "
+                   << settings.stopTime << "s, step " << settings.stepTime << "s, matrix "
+                   << matrixSize << "x" << matrixSize << ", Backward Euler");
 }
 
 void TransientAnalysis::solve() {
-    std::cout << "\n=== Starting Transient Analysis ===" << std::endl;
+    SPICE_LOG_INFO(Transient, "=== Starting Transient Analysis ===");
+    stats.reset();
+    cancelled = false;
+    if (progress) {
+        progress->startTime.store(settings.startTime, std::memory_order_relaxed);
+        progress->stopTime.store(settings.stopTime, std::memory_order_relaxed);
+        progress->time.store(settings.startTime, std::memory_order_relaxed);
+    }
+    
+    ScopedTraceEvent runEvent("transient", "analysis");
+    
+    // Element dispatch and node lookups happen once, not every step
+    {
+        ScopedPhaseTimer timer(stats, PerfPhase::Setup);
+        compileStamps();
+    }
     
     // Initialize with DC operating point
     initializeIC();
@@ -47,677 +74,326 @@ void TransientAnalysis::solve() {
     int timeStep = 0;
     
     // Save initial conditions
+    setupWaveforms();
     saveTimePoint(currentTime);
     
+    // Linear fixed-step circuits: factor once, then one forward/back
+    // substitution per step
+    bool linear = isLinearFixedStep();
+    bool nonlinear = !devices.isLinear();
+    bool factoredOnce = false;
+    if (linear) {
+        SPICE_LOG_INFO(Transient, "Linear circuit with fixed step: reusing a single LU factorization");
+    }
+    
     // Time stepping loop
     while (currentTime < settings.stopTime) {
+        if (progress && progress->cancelled()) {
+            SPICE_LOG_INFO(Transient, "Transient analysis cancelled at t = " << currentTime << "s");
+            cancelled = true;
+            break;
+        }
+        
         currentTime += settings.stepTime;
         timeStep++;
+        ScopedTraceEvent stepEvent("time step", "transient", "t", currentTime);
         
         if (timeStep % 100 == 0 || timeStep < 10) {
-            std::cout << "Time step " << timeStep << ": t = " 
-                      << std::scientific << std::setprecision(3) << currentTime << "s" << std::endl;
+            SPICE_LOG_DEBUG(Transient, "Time step " << timeStep << ": t = " 
+                            << std::scientific << std::setprecision(3) << currentTime << "s");
         }
         
-        // Build matrix for current time step
-        buildMNAMatrix(currentTime);
-        
-        // Solve linear system
-        if (!gaussianElimination()) {
-            std::cerr << "Transient analysis failed at time " << currentTime << std::endl;
-            break;
+        if (linear && factoredOnce) {
+            {
+                ScopedPhaseTimer timer(stats, PerfPhase::Assembly);
+                buildRHS();
+            }
+            ScopedPhaseTimer timer(stats, PerfPhase::Solve);
+            lu.solve(b, x);
+        } else {
+            ScopedTraceEvent solveEvent(nonlinear ? "nonlinear step" : "linear step", "transient");
+            
+            // Build matrix for current time step
+            {
+                ScopedPhaseTimer timer(stats, PerfPhase::Assembly);
+                buildMNAMatrix();
+            }
+            
+            // Solve linear system
+            if (!solveLinearSystem()) {
+                SPICE_LOG_ERROR(Transient, "Transient analysis failed at time " << currentTime);
+                stats.rejectedSteps++;
+                if (progress) progress->rejectedSteps.store(stats.rejectedSteps, std::memory_order_relaxed);
+                break;
+            }
+            if (nonlinear) stats.linearizations++;
+            factoredOnce = true;
         }
+        stats.timeSteps++;
         
-        // Save results and prepare for next time step
-        saveTimePoint(currentTime);
+        // Save results and prepare for next time step; the last step is
+        // always saved, whatever the output interval
+        saveTimePoint(currentTime, currentTime >= settings.stopTime);
         this->timeStep();
+        
+        if (progress) {
+            progress->time.store(currentTime, std::memory_order_relaxed);
+            progress->timeSteps.store(stats.timeSteps, std::memory_order_relaxed);
+            progress->linearizations.store(stats.linearizations, std::memory_order_relaxed);
+        }
+    }
+    
+    // Wait for the writer to drain; only what it has not overlapped with
+    // the time steps counts here
+    if (stream.isOpen()) {
+        ScopedPhaseTimer timer(stats, PerfPhase::Export);
+        stream.close();
     }
     
-    std::cout << "Transient analysis completed! " << results.size() << " time points saved." << std::endl;
-    printResults();
+    SPICE_LOG_INFO(Transient, "Transient analysis completed! " << savedPoints << " time points saved.");
+    if (Log::enabled(LogLevel::Info, LogCategory::Transient)) {
+        printResults();
+    }
 }
 
 void TransientAnalysis::initializeIC() {
-    std::cout << "Initializing with DC operating point..." << std::endl;
+    SPICE_LOG_DEBUG(Transient, "Initializing with DC operating point...");
     
     // For initial conditions, capacitors act as open circuits
     // This gives us the DC operating point
-    
-    // Clear matrices
-    for (int i = 0; i < matrixSize; i++) {
-        for (int j = 0; j < matrixSize; j++) {
-            G[i][j] = 0.0;
-        }
-        b[i] = 0.0;
-    }
-    
-    // Add resistors and voltage sources (capacitors ignored for DC)
-    for (const auto& element : elements) {
-        if (element->name.empty()) continue;
-        char type = std::tolower(element->name[0]);
-        
-        switch(type) {
-            case 'r': {
-                const Resistor* resistor = static_cast<const Resistor*>(element.get());
-                addResistor(resistor);
-                break;
-            }
-            case 'v': {
-                const VoltageSource* vsource = static_cast<const VoltageSource*>(element.get());
-                addVoltageSource(vsource, 0.0);  // DC value
-                break;
-            }
-            // Capacitors ignored for initial DC solution
-        }
+    {
+        ScopedPhaseTimer timer(stats, PerfPhase::Assembly);
+        icStamper.assemble(G, b);
     }
     
     // Solve for initial conditions
-    if (gaussianElimination()) {
+    initialConditions = solveLinearSystem();
+    if (initialConditions) {
         x_prev = x;  // Store as previous solution
-        std::cout << "Initial conditions established." << std::endl;
+        SPICE_LOG_DEBUG(Transient, "Initial conditions established.");
     } else {
-        std::cerr << "Failed to establish initial conditions!" << std::endl;
-    }
-}
-
-void TransientAnalysis::buildMNAMatrix(double currentTime) {
-    // Clear matrices
-    for (int i = 0; i < matrixSize; i++) {
-        for (int j = 0; j < matrixSize; j++) {
-            G[i][j] = 0.0;
-        }
-        b[i] = 0.0;
-    }
-    
-    // Add all circuit elements
-    for (const auto& element : elements) {
-        if (element->name.empty()) continue;
-        char type = std::tolower(element->name[0]);
-        
-        switch(type) {
-            case 'r': {
-                const Resistor* resistor = static_cast<const Resistor*>(element.get());
-                addResistor(resistor);
-                break;
-            }
-            case 'c': {
-                const Capacitor* capacitor = static_cast<const Capacitor*>(element.get());
-                addCapacitor(capacitor);
-                break;
-            }
-            case 'l': {
-                const Inductor* inductor = static_cast<const Inductor*>(element.get());
-                addInductor(inductor);
-                break;
-            }
-            case 'v': {
-                const VoltageSource* vsource = static_cast<const VoltageSource*>(element.get());
-                addVoltageSource(vsource, currentTime);
-                break;
-            }
-            case 'd': {
-                // Diodes in transient analysis - linearized around operating point
-                const Diode* diode = static_cast<const Diode*>(element.get());
-                addDiodeTransient(diode);
-                break;
-            }
-            case 'm': {
-                // MOSFET handling
-                if (const NMOSFET* nmos = dynamic_cast<const NMOSFET*>(element.get())) {
-                    addMOSFETTransient(nmos);
-                } else if (const PMOSFET* pmos = dynamic_cast<const PMOSFET*>(element.get())) {
-                    addPMOSFETTransient(pmos);
-                }
-                break;
-            }
-        }
+        SPICE_LOG_ERROR(Transient, "Failed to establish initial conditions!");
     }
 }
 
-void TransientAnalysis::addResistor(const Resistor* resistor) {
-    int n1 = resistor->pins[0].node_id;;
-    int n2 = resistor->pins[1].node_id;;
-    double conductance = 1.0 / resistor->r;
-    
-    // Same stamp as DC analysis
-    if (n1 == 0 && n2 == 0) return;
-    
-    if (n1 == 0) {
-        int node_idx = n2 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, conductance);
-        }
-        return;
-    }
-    
-    if (n2 == 0) {
-        int node_idx = n1 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, conductance);
-        }
-        return;
-    }
-    
-    // Both nodes non-ground
-    int idx1 = n1 - 1;
-    int idx2 = n2 - 1;
-    
-    if (idx1 >= 0 && idx1 < (numNodes-1)) {
-        addMatrixEntry(idx1, idx1, conductance);
-        if (idx2 >= 0 && idx2 < (numNodes-1)) {
-            addMatrixEntry(idx1, idx2, -conductance);
-        }
-    }
+void TransientAnalysis::compileStamps() {
+    devices.build(elements, numNodes, voltageSourceIndex);
+    icStamper.compile(devices, StampMode::TRANSIENT_INITIAL);
+    stepStamper.compile(devices, StampMode::TRANSIENT_STEP, settings.stepTime);
     
-    if (idx2 >= 0 && idx2 < (numNodes-1)) {
-        addMatrixEntry(idx2, idx2, conductance);
-        if (idx1 >= 0 && idx1 < (numNodes-1)) {
-            addMatrixEntry(idx2, idx1, -conductance);
-        }
-    }
+    SPICE_LOG_DEBUG(Transient, "Stamps compiled: " << stepStamper.stamps().matrixStampCount() << " matrix, "
+                    << stepStamper.stamps().rhsStampCount() << " RHS entries per step");
 }
 
-void TransientAnalysis::addVoltageSource(const VoltageSource* vsource, double currentTime) {
-    int n1 = vsource->pins[0].node_id;;
-    int n2 = vsource->pins[1].node_id;;
-    double voltage = vsource->v;  // For now, assume DC. Later add time-dependent sources
-    
-    auto it = voltageSourceIndex.find(vsource->name);
-    if (it == voltageSourceIndex.end()) return;
-    int vsIndex = it->second;
-    
-    // Same stamp as DC analysis
-    if (n1 != 0) {
-        int node_idx = n1 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, vsIndex, 1.0);
-            addMatrixEntry(vsIndex, node_idx, 1.0);
-        }
-    }
-    
-    if (n2 != 0) {
-        int node_idx = n2 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, vsIndex, -1.0);
-            addMatrixEntry(vsIndex, node_idx, -1.0);
-        }
-    }
-    
-    if (vsIndex >= 0 && vsIndex < matrixSize) {
-        b[vsIndex] = voltage;
-    }
+void TransientAnalysis::buildMNAMatrix() {
+    stepStamper.updateCompanionSources(x_prev);
+    stepStamper.updateLinearizations(x_prev);
+    stepStamper.assemble(G, b);
 }
 
-void TransientAnalysis::addCapacitor(const Capacitor* capacitor) {
-    int n1 = capacitor->pins[0].node_id;;
-    int n2 = capacitor->pins[1].node_id;;
-    
-    // Backward Euler: C * dv/dt ≈ C * (v_current - v_previous) / dt
-    // This creates an equivalent conductance: Geq = C/dt
-    // And an equivalent current source: Ieq = Geq * v_previous
-    
-    double equiv_conductance = getCapacitorEquivalentConductance(capacitor);
-    
-    // Get previous voltages across capacitor
-    double v1_prev = (n1 == 0) ? 0.0 : ((n1-1 < x_prev.size()) ? x_prev[n1-1] : 0.0);
-    double v2_prev = (n2 == 0) ? 0.0 : ((n2-1 < x_prev.size()) ? x_prev[n2-1] : 0.0);
-    double v_cap_prev = v1_prev - v2_prev;
-    
-    double equiv_current = getCapacitorEquivalentCurrentSource(capacitor, v_cap_prev);
-    
-    // Stamp equivalent conductance (like a resistor)
-    if (n1 == 0 && n2 == 0) return;
-    
-    if (n1 == 0) {
-        int node_idx = n2 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, equiv_conductance);
-            b[node_idx] += equiv_current;  // Current source
-        }
-        return;
-    }
-    
-    if (n2 == 0) {
-        int node_idx = n1 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, equiv_conductance);
-            b[node_idx] -= equiv_current;  // Current source (opposite direction)
-        }
-        return;
-    }
-    
-    // Both nodes non-ground
-    int idx1 = n1 - 1;
-    int idx2 = n2 - 1;
-    
-    if (idx1 >= 0 && idx1 < (numNodes-1)) {
-        addMatrixEntry(idx1, idx1, equiv_conductance);
-        b[idx1] -= equiv_current;
-        
-        if (idx2 >= 0 && idx2 < (numNodes-1)) {
-            addMatrixEntry(idx1, idx2, -equiv_conductance);
-        }
-    }
-    
-    if (idx2 >= 0 && idx2 < (numNodes-1)) {
-        addMatrixEntry(idx2, idx2, equiv_conductance);
-        b[idx2] += equiv_current;
-        
-        if (idx1 >= 0 && idx1 < (numNodes-1)) {
-            addMatrixEntry(idx2, idx1, -equiv_conductance);
-        }
-    }
-}
-
-double TransientAnalysis::getCapacitorEquivalentConductance(const Capacitor* cap) {
-    // Backward Euler: Geq = C / dt
-    return cap->c / settings.stepTime;
+void TransientAnalysis::buildRHS() {
+    // Matrix is unchanged (linear circuit, fixed step); only sources and
+    // companion-model history terms move
+    stepStamper.updateCompanionSources(x_prev);
+    stepStamper.assembleRHS(b);
 }
 
-double TransientAnalysis::getCapacitorEquivalentCurrentSource(const Capacitor* cap, double v_previous) {
-    // Backward Euler: Ieq = (C / dt) * v_previous
-    return getCapacitorEquivalentConductance(cap) * v_previous;
+bool TransientAnalysis::isLinearFixedStep() const {
+    // Companion conductances depend only on C, L and dt, so with no
+    // nonlinear devices and a constant step the matrix never changes
+    return settings.stepTime > 0.0 && devices.isLinear();
 }
 
-void TransientAnalysis::addInductor(const Inductor* inductor) {
-    int n1 = inductor->pins[0].node_id;
-    int n2 = inductor->pins[1].node_id;
-    
-    // Backward Euler: L * di/dt ≈ L * (i_current - i_previous) / dt
-    // This creates voltage equation: V = L * (i_current - i_previous) / dt
-    // Rearranging: i_current = (V * dt / L) + i_previous
-    // This is equivalent to a resistor with R = dt/L in parallel with current source
-    
-    double equiv_resistance = settings.stepTime / inductor->l;
-    double equiv_conductance = 1.0 / equiv_resistance;
-    
-    // Get previous current through inductor (stored separately)
-    double i_prev = getInductorPreviousCurrent(inductor);
-    double equiv_current = i_prev;  // Current source to maintain continuity
-    
-    std::cout << "Inductor " << inductor->name << ": Geq=" << equiv_conductance 
-              << " S, Ieq=" << equiv_current << " A" << std::endl;
-    
-    // Stamp like a resistor with current source
-    if (n1 == 0 && n2 == 0) return;
-    
-    if (n1 == 0) {
-        int node_idx = n2 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, equiv_conductance);
-            b[node_idx] -= equiv_current;
-        }
-        return;
-    }
-    
-    if (n2 == 0) {
-        int node_idx = n1 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, equiv_conductance);
-            b[node_idx] += equiv_current;
-        }
-        return;
-    }
-    
-    // Both nodes non-ground
-    int idx1 = n1 - 1;
-    int idx2 = n2 - 1;
-    
-    if (idx1 >= 0 && idx1 < (numNodes-1)) {
-        addMatrixEntry(idx1, idx1, equiv_conductance);
-        b[idx1] += equiv_current;
-        
-        if (idx2 >= 0 && idx2 < (numNodes-1)) {
-            addMatrixEntry(idx1, idx2, -equiv_conductance);
+bool TransientAnalysis::solveLinearSystem() {
+    // Pattern is fixed across time steps, so the sparse path only refactors
+    stats.recordMatrix(matrixSize, G.nonZeros());
+    {
+        ScopedPhaseTimer timer(stats, PerfPhase::Factor);
+        if (!lu.factorize(G)) {
+            return false;
         }
     }
+    stats.recordFactorization(lu.factorNonZeros());
     
-    if (idx2 >= 0 && idx2 < (numNodes-1)) {
-        addMatrixEntry(idx2, idx2, equiv_conductance);
-        b[idx2] -= equiv_current;
-        
-        if (idx1 >= 0 && idx1 < (numNodes-1)) {
-            addMatrixEntry(idx2, idx1, -equiv_conductance);
-        }
-    }
+    ScopedPhaseTimer timer(stats, PerfPhase::Solve);
+    lu.solve(b, x);
+    return true;
 }
 
-void TransientAnalysis::addDiodeTransient(const Diode* diode) {
-    int n1 = diode->pins[0].node_id;  // anode
-    int n2 = diode->pins[1].node_id;  // cathode
-    
-    // Get previous voltage across diode for linearization
-    double v1_prev = (n1 == 0) ? 0.0 : ((n1-1 < x_prev.size()) ? x_prev[n1-1] : 0.0);
-    double v2_prev = (n2 == 0) ? 0.0 : ((n2-1 < x_prev.size()) ? x_prev[n2-1] : 0.0);
-    double v_diode_prev = v1_prev - v2_prev;
-    
-    // Linearize around previous operating point
-    double conductance = diode->getConductance(v_diode_prev);
-    double current_prev = diode->getCurrent(v_diode_prev);
-    double current_source = current_prev - conductance * v_diode_prev;
-    
-    std::cout << "Diode " << diode->name << " linearized: G=" << conductance 
-              << " S, Is=" << current_source << " A" << std::endl;
-    
-    // Stamp conductance and current source
-    if (n1 == 0 && n2 == 0) return;
-    
-    if (n1 == 0) {
-        int node_idx = n2 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, conductance);
-            b[node_idx] += current_source;
-        }
-        return;
-    }
-    
-    if (n2 == 0) {
-        int node_idx = n1 - 1;
-        if (node_idx >= 0 && node_idx < (numNodes-1)) {
-            addMatrixEntry(node_idx, node_idx, conductance);
-            b[node_idx] -= current_source;
-        }
-        return;
-    }
-    
-    // Both nodes non-ground
-    int idx1 = n1 - 1;
-    int idx2 = n2 - 1;
-    
-    if (idx1 >= 0 && idx1 < (numNodes-1)) {
-        addMatrixEntry(idx1, idx1, conductance);
-        b[idx1] -= current_source;
-        
-        if (idx2 >= 0 && idx2 < (numNodes-1)) {
-            addMatrixEntry(idx1, idx2, -conductance);
-        }
-    }
-    
-    if (idx2 >= 0 && idx2 < (numNodes-1)) {
-        addMatrixEntry(idx2, idx2, conductance);
-        b[idx2] += current_source;
-        
-        if (idx1 >= 0 && idx1 < (numNodes-1)) {
-            addMatrixEntry(idx2, idx1, -conductance);
-        }
-    }
+void TransientAnalysis::timeStep() {
+    // Prepare for next time step
+    x_prev = x;
 }
 
-void TransientAnalysis::addMOSFETTransient(const NMOSFET* mosfet) {
-    int nd = mosfet->pins[0].node_id;  // drain
-    int ng = mosfet->pins[1].node_id;  // gate  
-    int ns = mosfet->pins[2].node_id;  // source
-    int nb = mosfet->pins[3].node_id;  // bulk
+void TransientAnalysis::setupWaveforms() {
+    waveforms.clear();
+    nodeSignal.assign(numNodes, -1);
+    savedUnknowns.clear();
     
-    // Get previous voltages for linearization
-    double vd_prev = (nd == 0) ? 0.0 : ((nd-1 < x_prev.size()) ? x_prev[nd-1] : 0.0);
-    double vg_prev = (ng == 0) ? 0.0 : ((ng-1 < x_prev.size()) ? x_prev[ng-1] : 0.0);
-    double vs_prev = (ns == 0) ? 0.0 : ((ns-1 < x_prev.size()) ? x_prev[ns-1] : 0.0);
-    
-    double vgs_prev = vg_prev - vs_prev;
-    double vds_prev = vd_prev - vs_prev;
-    
-    // Calculate small-signal parameters at operating point
-    double gm = mosfet->getTransconductance(vgs_prev, vds_prev);
-    double gds = mosfet->getOutputConductance(vgs_prev, vds_prev);
-    double id_prev = mosfet->getDrainCurrent(vgs_prev, vds_prev);
-    
-    // Current source for linearization: Is = Id - gm*Vgs - gds*Vds
-    double current_source = id_prev - gm * vgs_prev - gds * vds_prev;
-    
-    std::cout << "NMOSFET " << mosfet->name << " linearized: gm=" << gm 
-              << " S, gds=" << gds << " S, Is=" << current_source << " A" << std::endl;
-    
-    // Stamp transconductance (gate-source to drain-source current)
-    // Id = gm * Vgs, so drain gets +gm*Vg - gm*Vs, source gets opposite
-    if (nd != 0 && ng != 0) {
-        int idx_d = nd - 1;
-        int idx_g = ng - 1;
-        
-        if (idx_d >= 0 && idx_d < (numNodes-1) && idx_g >= 0 && idx_g < (numNodes-1)) {
-            addMatrixEntry(idx_d, idx_g, gm);   // gm * Vg contributes to Id
-        }
+    // Node voltages in node order, then source currents in name order,
+    // whatever order they were requested in
+    std::vector<bool> selected(numNodes, saves.all);
+    for (int node : saves.nodes) {
+        if (node > 0 && node < numNodes) selected[node] = true;
     }
-    
-    if (nd != 0 && ns != 0) {
-        int idx_d = nd - 1;
-        int idx_s = ns - 1;
-        
-        if (idx_d >= 0 && idx_d < (numNodes-1) && idx_s >= 0 && idx_s < (numNodes-1)) {
-            addMatrixEntry(idx_d, idx_s, -gm);  // -gm * Vs contributes to Id
-        }
+    for (int i = 1; i < numNodes; i++) {
+        if (!selected[i]) continue;
+        nodeSignal[i] = waveforms.addSignal("v(" + std::to_string(i) + ")");
+        savedUnknowns.push_back(i - 1);
     }
-    
-    // Stamp output conductance (drain-source)
-    if (nd != 0 && ns != 0) {
-        int idx_d = nd - 1;
-        int idx_s = ns - 1;
-        
-        if (idx_d >= 0 && idx_d < (numNodes-1)) {
-            addMatrixEntry(idx_d, idx_d, gds);
-            b[idx_d] -= current_source;  // Drain gets positive current
-            
-            if (idx_s >= 0 && idx_s < (numNodes-1)) {
-                addMatrixEntry(idx_d, idx_s, -gds);
-            }
-        }
-        
-        if (idx_s >= 0 && idx_s < (numNodes-1)) {
-            addMatrixEntry(idx_s, idx_s, gds);
-            b[idx_s] += current_source;  // Source gets negative current
-            
-            if (idx_d >= 0 && idx_d < (numNodes-1)) {
-                addMatrixEntry(idx_s, idx_d, -gds);
-            }
-        }
+    for (const auto& vs : voltageSourceIndex) {
+        bool wanted = saves.all || std::any_of(saves.currents.begin(), saves.currents.end(),
+                                               [&](const std::string& name) { return sameName(name, vs.first); });
+        if (!wanted) continue;
+        waveforms.addSignal("i(" + vs.first + ")");
+        savedUnknowns.push_back(vs.second);
     }
-    
-    // Add transconductance contribution to source node
-    if (ns != 0 && ng != 0) {
-        int idx_s = ns - 1;
-        int idx_g = ng - 1;
-        
-        if (idx_s >= 0 && idx_s < (numNodes-1) && idx_g >= 0 && idx_g < (numNodes-1)) {
-            addMatrixEntry(idx_s, idx_g, -gm);  // Source gets opposite of drain
+    for (const auto& name : saves.currents) {
+        if (waveforms.findSignal("i(" + name + ")") < 0) {
+            SPICE_LOG_WARN(Transient, "Cannot save i(" << name << "): no such voltage source");
         }
     }
     
-    if (ns != 0) {
-        int idx_s = ns - 1;
-        if (idx_s >= 0 && idx_s < (numNodes-1)) {
-            addMatrixEntry(idx_s, idx_s, gm);   // Source self-contribution
+    savedRow.assign(waveforms.signalCount(), 0.0);
+    nextSaveTime = settings.startTime;
+    savedPoints = 0;
+    
+    if (streamSink) {
+        std::vector<std::string> names;
+        for (size_t s = 0; s < waveforms.signalCount(); s++) {
+            names.push_back(waveforms.signalName(static_cast<int>(s)));
         }
+        stream.open(std::move(streamSink), names);
     }
 }
 
-void TransientAnalysis::addPMOSFETTransient(const PMOSFET* mosfet) {
-    // Similar to NMOS but with opposite polarity considerations
-    int nd = mosfet->pins[0].node_id;  // drain
-    int ng = mosfet->pins[1].node_id;  // gate  
-    int ns = mosfet->pins[2].node_id;  // source
-    int nb = mosfet->pins[3].node_id;  // bulk
-    
-    // For PMOS, we typically work with source-gate and source-drain voltages
-    double vd_prev = (nd == 0) ? 0.0 : ((nd-1 < x_prev.size()) ? x_prev[nd-1] : 0.0);
-    double vg_prev = (ng == 0) ? 0.0 : ((ng-1 < x_prev.size()) ? x_prev[ng-1] : 0.0);
-    double vs_prev = (ns == 0) ? 0.0 : ((ns-1 < x_prev.size()) ? x_prev[ns-1] : 0.0);
-    
-    double vsg_prev = vs_prev - vg_prev;  // Source-gate for PMOS
-    double vsd_prev = vs_prev - vd_prev;  // Source-drain for PMOS
-    
-    // For simplicity, use similar small-signal model as NMOS
-    double gm = 50e-6;  // Simplified transconductance
-    double gds = 1e-6;  // Simplified output conductance
-    
-    std::cout << "PMOSFET " << mosfet->name << " using simplified model" << std::endl;
-    
-    // Similar stamping as NMOS but consider PMOS polarity
-    // Implementation details would follow PMOS device equations
+void TransientAnalysis::setResultStream(std::unique_ptr<WaveformSink> sink, bool keep) {
+    streamSink = std::move(sink);
+    keepResults = keep;
 }
 
-double TransientAnalysis::getInductorPreviousCurrent(const Inductor* inductor) {
-    
-    // TODO: Implement inductor current history tracking
-    return 0.0;
-}
-
-void TransientAnalysis::addMatrixEntry(int row, int col, double value) {
-    if (row >= 0 && row < matrixSize && col >= 0 && col < matrixSize) {
-        G[row][col] += value;
-    }
-}
-
-bool TransientAnalysis::gaussianElimination() {
-    // Same Gaussian elimination as DC analysis
-    const double EPSILON = 1e-12;
-    
-    for (int i = 0; i < matrixSize; i++) {
-        int maxRow = i;
-        for (int k = i + 1; k < matrixSize; k++) {
-            if (std::abs(G[k][i]) > std::abs(G[maxRow][i])) {
-                maxRow = k;
-            }
-        }
-        
-        if (maxRow != i) {
-            std::swap(G[i], G[maxRow]);
-            std::swap(b[i], b[maxRow]);
-        }
-        
-        if (std::abs(G[i][i]) < EPSILON) {
-            return false;
-        }
-        
-        for (int k = i + 1; k < matrixSize; k++) {
-            double factor = G[k][i] / G[i][i];
-            b[k] -= factor * b[i];
-            for (int j = i; j < matrixSize; j++) {
-                G[k][j] -= factor * G[i][j];
-            }
-        }
-    }
-    
-    for (int i = matrixSize - 1; i >= 0; i--) {
-        x[i] = b[i];
-        for (int j = i + 1; j < matrixSize; j++) {
-            x[i] -= G[i][j] * x[j];
-        }
-        x[i] /= G[i][i];
+void TransientAnalysis::streamExport(const std::string& filename, bool keep) {
+    bool binary = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".spw") == 0;
+    if (binary) {
+        setResultStream(std::make_unique<BinaryWaveformSink>(filename), keep);
+    } else {
+        setResultStream(csvExportSink(filename), keep);
     }
-    
-    return true;
 }
 
-void TransientAnalysis::timeStep() {
-    // Prepare for next time step
-    x_prev = x;
+std::unique_ptr<WaveformSink> TransientAnalysis::csvExportSink(const std::string& filename) const {
+    // Saved node voltages as NodeN, and the source currents asked for by
+    // name; currents saved only through "all" are left out
+    TextWaveformSink::Format format;
+    format.label = [currents = saves.currents](const std::string& signal) -> std::string {
+        if (signal.compare(0, 2, "v(") == 0) {
+            return "Node" + signal.substr(2, signal.size() - 3);
+        }
+        for (const auto& name : currents) {
+            if (sameName("i(" + name + ")", signal)) return signal;
+        }
+        return "";
+    };
+    return std::make_unique<TextWaveformSink>(filename, std::move(format));
 }
 
-void TransientAnalysis::saveTimePoint(double currentTime) {
-    TimePoint point;
-    point.time = currentTime;
+void TransientAnalysis::saveTimePoint(double currentTime, bool force) {
+    // With an output interval, keep the first step at or past each
+    // multiple of it (half a step of slack absorbs rounding in the time)
+    const double slack = 0.5 * settings.stepTime;
+    if (saves.interval > 0.0 && !force && currentTime + slack < nextSaveTime) return;
     
-    // Save node voltages
-    point.nodeVoltages.resize(numNodes);
-    point.nodeVoltages[0] = 0.0;  // Ground
+    ScopedPhaseTimer timer(stats, PerfPhase::Save);
     
-    for (int i = 1; i < numNodes; i++) {
-        if ((i-1) < static_cast<int>(x.size())) {
-            point.nodeVoltages[i] = x[i-1];
-        } else {
-            point.nodeVoltages[i] = 0.0;
-        }
+    for (size_t k = 0; k < savedUnknowns.size(); k++) {
+        int row = savedUnknowns[k];
+        savedRow[k] = row < static_cast<int>(x.size()) ? x[row] : 0.0;
     }
+    if (keepResults) waveforms.append(currentTime, savedRow.data());
+    if (stream.isOpen()) stream.append(currentTime, savedRow.data());
+    savedPoints++;
     
-    // Save voltage source currents
-    for (const auto& vs : voltageSourceIndex) {
-        if (vs.second < static_cast<int>(x.size())) {
-            point.branchCurrents[vs.first] = x[vs.second];
-        }
+    if (saves.interval > 0.0) {
+        double intervals = std::floor((currentTime - settings.startTime + slack) / saves.interval);
+        nextSaveTime = settings.startTime + (intervals + 1.0) * saves.interval;
     }
-    
-    results.push_back(point);
 }
 
 void TransientAnalysis::printResults() {
     std::cout << "\n=== Transient Analysis Results ===" << std::endl;
-    std::cout << "Total time points: " << results.size() << std::endl;
+    std::cout << "Total time points: " << waveforms.size() << std::endl;
     
     // Print first few and last few points
-    int printCount = std::min(5, static_cast<int>(results.size()));
+    int printCount = std::min(5, static_cast<int>(waveforms.size()));
     
     std::cout << "\nFirst " << printCount << " time points:" << std::endl;
     std::cout << std::setw(12) << "Time(s)";
     for (int i = 1; i < numNodes; i++) {
+        if (nodeSignal[i] < 0) continue;
         std::cout << std::setw(12) << ("Node" + std::to_string(i));
     }
     std::cout << std::endl;
     
-    for (int i = 0; i < printCount; i++) {
-        const auto& point = results[i];
-        std::cout << std::scientific << std::setprecision(3) << std::setw(12) << point.time;
+    auto printRow = [&](size_t row) {
+        std::cout << std::scientific << std::setprecision(3) << std::setw(12) << waveforms.time(row);
         for (int j = 1; j < numNodes; j++) {
-            std::cout << std::fixed << std::setprecision(6) << std::setw(12) << point.nodeVoltages[j];
+            if (nodeSignal[j] < 0) continue;
+            std::cout << std::fixed << std::setprecision(6) << std::setw(12) << waveforms.value(nodeSignal[j], row);
         }
         std::cout << std::endl;
+    };
+    
+    for (int i = 0; i < printCount; i++) {
+        printRow(i);
     }
     
-    if (results.size() > 10) {
+    if (waveforms.size() > 10) {
         std::cout << "..." << std::endl;
         std::cout << "Last " << printCount << " time points:" << std::endl;
         
-        for (int i = results.size() - printCount; i < static_cast<int>(results.size()); i++) {
-            const auto& point = results[i];
-            std::cout << std::scientific << std::setprecision(3) << std::setw(12) << point.time;
-            for (int j = 1; j < numNodes; j++) {
-                std::cout << std::fixed << std::setprecision(6) << std::setw(12) << point.nodeVoltages[j];
-            }
-            std::cout << std::endl;
+        for (size_t i = waveforms.size() - printCount; i < waveforms.size(); i++) {
+            printRow(i);
         }
     }
 }
 
 void TransientAnalysis::exportResults(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Could not open " << filename << " for writing." << std::endl;
-        return;
-    }
+    ScopedPhaseTimer timer(stats, PerfPhase::Export);
     
-    // Write header
-    file << "Time";
-    for (int i = 1; i < numNodes; i++) {
-        file << ",Node" << i;
+    try {
+        writeWaveforms(waveforms, *csvExportSink(filename));
+    } catch (const std::runtime_error& e) {
+        SPICE_LOG_ERROR(Transient, e.what());
+        return;
     }
-    file << std::endl;
+    SPICE_LOG_INFO(Transient, "Results exported to " << filename);
+}
+
+void TransientAnalysis::exportBinary(const std::string& filename) {
+    ScopedPhaseTimer timer(stats, PerfPhase::Export);
     
-    // Write data
-    for (const auto& point : results) {
-        file << std::scientific << std::setprecision(6) << point.time;
-        for (int i = 1; i < numNodes; i++) {
-            file << "," << std::fixed << std::setprecision(6) << point.nodeVoltages[i];
-        }
-        file << std::endl;
+    try {
+        writeWaveformFile(waveforms, filename);
+    } catch (const std::runtime_error& e) {
+        SPICE_LOG_ERROR(Transient, e.what());
+        return;
     }
-    
-    file.close();
-    std::cout << "Results exported to " << filename << std::endl;
+    SPICE_LOG_INFO(Transient, "Results exported to " << filename);
 }
 
 std::vector<double> TransientAnalysis::getNodeVoltageHistory(int node) const {
-    std::vector<double> history;
-    for (const auto& point : results) {
-        if (node < static_cast<int>(point.nodeVoltages.size())) {
-            history.push_back(point.nodeVoltages[node]);
-        }
+    if (node < 0 || node >= static_cast<int>(nodeSignal.size())) {
+        return {};
+    }
+    if (node == 0) {
+        return std::vector<double>(waveforms.size(), 0.0);  // Ground
     }
-    return history;
+    if (nodeSignal[node] < 0) {
+        return {};  // Not saved
+    }
+    return waveforms.signal(nodeSignal[node]);
 }
 
 std::vector<double> TransientAnalysis::getTimePoints() const {
-    std::vector<double> times;
-    for (const auto& point : results) {
-        times.push_back(point.time);
-    }
-    return times;
-}
\ No newline at end of file
+    return waveforms.times();
+}
@@ -4,7 +4,15 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <string>
 #include "parser/circuit_element.h"
+#include "simulation/sparse_matrix.h"
+#include "simulation/linear_solver.h"
+#include "simulation/device_stamper.h"
+#include "simulation/simulation_progress.h"
+#include "simulation/waveform_store.h"
+#include "simulation/waveform_stream.h"
+#include "util/perf_stats.h"
 
 struct TransientSettings {
     double stepTime;    // Time step (e.g., 1e-9 for 1ns)
@@ -15,20 +23,23 @@ struct TransientSettings {
         : stepTime(step), stopTime(stop), startTime(start) {}
 };
 
-struct TimePoint {
-    double time;
-    std::vector<double> nodeVoltages;
-    std::map<std::string, double> branchCurrents;
+// Signals a transient analysis records (.save / .probe)
+struct SaveSettings {
+    bool all = true;                    // every node voltage and source current
+    std::vector<int> nodes;             // v(node), by node number
+    std::vector<std::string> currents;  // i(name), by voltage source name
+    double interval = 0.0;              // output interval; 0 saves every step
 };
 
 class TransientAnalysis {
 private:
-    std::vector<std::unique_ptr<CircuitElement>>& elements;
+    const std::vector<std::unique_ptr<CircuitElement>>& elements;
     int numNodes;
     TransientSettings settings;
     
     // Current time step matrices
-    std::vector<std::vector<double>> G;  // Conductance matrix
+    SparseMatrix G;                      // Conductance matrix
+    LinearSolver lu;                     // Factorization of G, reused across solves
     std::vector<double> b;               // Right-hand side
     std::vector<double> x;               // Current solution
     std::vector<double> x_prev;          // Previous time step solution
@@ -36,8 +47,20 @@ private:
     int matrixSize;
     std::map<std::string, int> voltageSourceIndex;
     
-    // Results storage
-    std::vector<TimePoint> results;
+    // Results storage: v(n) for the saved nodes, then i(name) for the
+    // saved voltage sources
+    SaveSettings saves;
+    WaveformStore waveforms;
+    std::vector<int> nodeSignal;         // by node number; -1 if not saved
+    std::vector<int> savedUnknowns;      // solution index of each signal
+    std::vector<double> savedRow;        // one row being saved
+    double nextSaveTime = 0.0;           // with an output interval
+    size_t savedPoints = 0;
+    
+    // Rows also go to a writer thread while solving, if a sink is set
+    std::unique_ptr<WaveformSink> streamSink;
+    WaveformStream stream;
+    bool keepResults = true;
     
     // Integration method
     enum class IntegrationMethod {
@@ -46,42 +69,96 @@ private:
     };
     IntegrationMethod method = IntegrationMethod::BACKWARD_EULER;
     
+    // Typed device records, and their precompiled stamps for the DC
+    // operating point (R, V) and for every time step (companion models)
+    DeviceSet devices;
+    DeviceStamper icStamper;
+    DeviceStamper stepStamper;
+    
+    PerfStats stats;
+    
+    SimulationProgress* progress = nullptr;
+    bool cancelled = false;
+    bool initialConditions = false;
+    
 public:
-    TransientAnalysis(std::vector<std::unique_ptr<CircuitElement>>& elems, 
+    TransientAnalysis(const std::vector<std::unique_ptr<CircuitElement>>& elems, 
                      int nodes, const TransientSettings& settings);
     
     void solve();
     void printResults();
     void exportResults(const std::string& filename);
+    // All saved signals (node voltages and source currents) as a binary
+    // .spw waveform file; see waveform_file.h
+    void exportBinary(const std::string& filename);
     
-    // Getters for specific time points
+    // Getters for specific time points. Ground reads as zeros; nodes that
+    // were not saved give an empty vector.
     std::vector<double> getNodeVoltageHistory(int node) const;
     std::map<std::string, std::vector<double>> inductorCurrentHistory;
     std::vector<double> getTimePoints() const;
     
+    // Matrix ordering used by the sparse LU factorization (default AMD)
+    void setOrdering(OrderingMethod method) { lu.setOrdering(method); }
+    // Systems smaller than this use the dense LU
+    void setDenseThreshold(int size) { lu.setDenseThreshold(size); }
+    const OrderingStats& getOrderingStats() const { return lu.orderingStats(); }
+    
+    // Phase timings and counters of the last solve()
+    const PerfStats& getStats() const { return stats; }
+    
+    // Publish progress to, and poll cancellation from, another thread. A
+    // cancel request stops solve() before the next time step; the points
+    // computed so far are kept.
+    void setProgress(SimulationProgress* sink) { progress = sink; }
+    bool wasCancelled() const { return cancelled; }
+    // False if the last solve() could not find the initial operating point
+    // (singular start-up matrix), so its waveforms are not meaningful
+    bool hasInitialConditions() const { return initialConditions; }
+    
+    // Signals to record, and how often; applies from the next solve()
+    void setSaveSettings(const SaveSettings& settings) { saves = settings; }
+    const SaveSettings& getSaveSettings() const { return saves; }
+    
+    // Saved waveforms. Rows past the memory budget (0: unlimited) are
+    // spilled to spillFile, or to a temporary file if it is empty; with
+    // compression on, full chunks are kept packed.
+    const WaveformStore& getWaveforms() const { return waveforms; }
+    // Waveform signal holding a node's voltage, or -1 (ground, not saved)
+    int getNodeSignal(int node) const {
+        return node >= 0 && node < static_cast<int>(nodeSignal.size()) ? nodeSignal[node] : -1;
+    }
+    void setResultMemoryBudget(size_t bytes, const std::string& spillFile = "") {
+        waveforms.setMemoryBudget(bytes, spillFile);
+    }
+    void setResultCompression(bool enabled) { waveforms.setCompression(enabled); }
+    
+    // Hands the saved rows to sink on a writer thread during the next
+    // solve(), so output is written while the time steps run. With
+    // keepResults false the rows are not kept in getWaveforms() either,
+    // and memory stays bounded however long the run. solve() throws
+    // std::runtime_error if the sink fails.
+    void setResultStream(std::unique_ptr<WaveformSink> sink, bool keepResults = true);
+    // Streams what exportBinary() (filename ending in .spw) or
+    // exportResults() would write afterwards
+    void streamExport(const std::string& filename, bool keepResults = true);
+    
 private:
     void initializeIC();  // Initial conditions
-    void buildMNAMatrix(double currentTime);
+    // Sources are DC only, so neither depends on the time point
+    void buildMNAMatrix();
+    void buildRHS();
+    bool isLinearFixedStep() const;
     void timeStep();
-    bool gaussianElimination();
-    
-    // Device stamps for transient analysis
-    void addResistor(const Resistor* resistor);
-    void addVoltageSource(const VoltageSource* vsource, double currentTime);
-    void addCapacitor(const Capacitor* capacitor);
-    void addInductor(const Inductor* inductor);
-    void addDiodeTransient(const Diode* diode);
-    void addMOSFETTransient(const NMOSFET* mosfet);
-    void addPMOSFETTransient(const PMOSFET* pmos);
-    
-    void addMatrixEntry(int row, int col, double value);
-    void saveTimePoint(double currentTime);
-    
-    // Integration methods
-    double getCapacitorCurrent(const Capacitor* cap, double v_current, double v_previous);
-    double getCapacitorEquivalentConductance(const Capacitor* cap);
-    double getCapacitorEquivalentCurrentSource(const Capacitor* cap, double v_previous);
-    double getInductorPreviousCurrent(const Inductor* inductor);
+    bool solveLinearSystem();
+    
+    // Resolve devices and compile the start-up and per-step stamps
+    void compileStamps();
+    
+    void setupWaveforms();
+    std::unique_ptr<WaveformSink> csvExportSink(const std::string& filename) const;
+    // Skipped between output intervals unless force is set
+    void saveTimePoint(double currentTime, bool force = false);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "waveform_codec.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+enum Predictor : unsigned char {
+    PREVIOUS = 0,
+    LINEAR = 1,
+};
+
+std::uint64_t bitsOf(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double valueOf(std::uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int leadingZeros(std::uint64_t x) {   // x != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    for (; !(x & (std::uint64_t(1) << 63)); x <<= 1) n++;
+    return n;
+#endif
+}
+
+int trailingZeros(std::uint64_t x) {  // x != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    for (; !(x & 1); x >>= 1) n++;
+    return n;
+#endif
+}
+
+// Prediction of values[index] from the two before it. The extrapolation is
+// written without a multiply, so it cannot be contracted into an FMA, and
+// is only used when finite: finite IEEE arithmetic rounds the same on every
+// platform, so the decoder reproduces the guess bit for bit.
+double predict(Predictor predictor, const double* values, std::size_t index) {
+    double previous = values[index - 1];
+    if (predictor == LINEAR && index >= 2) {
+        double guess = previous + (previous - values[index - 2]);
+        if (std::isfinite(guess)) return guess;
+    }
+    return previous;
+}
+
+// Most significant bit first, into a buffer the caller sized for the worst
+// case. Bits collect in a 64-bit word and leave it a byte at a time.
+class BitWriter {
+private:
+    unsigned char* out;
+    std::uint64_t pending = 0;  // the low `used` bits are not written yet
+    int used = 0;               // < 8 between calls
+
+public:
+    explicit BitWriter(unsigned char* out) : out(out) {}
+
+    // value must fit in count bits
+    void put(std::uint64_t value, int count) {
+        if (count > 32) {
+            put(value >> 32, count - 32);
+            value &= 0xffffffffu;
+            count = 32;
+        }
+        pending = (pending << count) | value;
+        used += count;
+        while (used >= 8) {
+            used -= 8;
+            *out++ = static_cast<unsigned char>(pending >> used);
+        }
+    }
+
+    // Writes the last partial byte; returns the end of the output
+    unsigned char* flush() {
+        if (used > 0) *out++ = static_cast<unsigned char>(pending << (8 - used));
+        pending = 0;
+        used = 0;
+        return out;
+    }
+};
+
+// Reads past the end as zeros and remembers that it did
+class BitReader {
+private:
+    const unsigned char* data;
+    std::size_t bytes;
+    std::size_t position = 0;   // next byte
+    std::uint64_t pending = 0;  // the low `available` bits are unread
+    int available = 0;
+
+public:
+    bool overrun = false;
+
+    BitReader(const unsigned char* data, std::size_t bytes) : data(data), bytes(bytes) {}
+
+    std::uint64_t get(int count) {
+        if (count > 32) {
+            std::uint64_t high = get(count - 32);
+            return (high << 32) | get(32);
+        }
+        while (available < count) {
+            unsigned byte = 0;
+            if (position < bytes) {
+                byte = data[position++];
+            } else {
+                overrun = true;
+            }
+            pending = (pending << 8) | byte;
+            available += 8;
+        }
+        available -= count;
+        return (pending >> available) & ((std::uint64_t(1) << count) - 1);
+    }
+};
+
+// Bits of XOR left after each predictor, ignoring the control bits: enough
+// to pick the better one without encoding twice
+Predictor choosePredictor(const double* values, std::size_t count) {
+    std::uint64_t previousBits = 0;
+    std::uint64_t linearBits = 0;
+    for (std::size_t i = 1; i < count; i++) {
+        std::uint64_t value = bitsOf(values[i]);
+        std::uint64_t x = value ^ bitsOf(predict(PREVIOUS, values, i));
+        std::uint64_t y = value ^ bitsOf(predict(LINEAR, values, i));
+        if (x) previousBits += 64 - leadingZeros(x) - trailingZeros(x);
+        if (y) linearBits += 64 - leadingZeros(y) - trailingZeros(y);
+    }
+    return linearBits < previousBits ? LINEAR : PREVIOUS;
+}
+
+unsigned char* encodeWith(Predictor predictor, const double* values, std::size_t count, unsigned char* out) {
+    *out++ = predictor;
+    BitWriter writer(out);
+    writer.put(bitsOf(values[0]), 64);
+
+    int windowLeading = -1;     // no window yet
+    int windowTrailing = 0;
+    for (std::size_t i = 1; i < count; i++) {
+        std::uint64_t x = bitsOf(values[i]) ^ bitsOf(predict(predictor, values, i));
+        if (x == 0) {
+            writer.put(0, 1);
+            continue;
+        }
+        int leading = leadingZeros(x);
+        int trailing = trailingZeros(x);
+        if (windowLeading >= 0 && leading >= windowLeading && trailing >= windowTrailing) {
+            writer.put(0x2, 2);
+            writer.put(x >> windowTrailing, 64 - windowLeading - windowTrailing);
+        } else {
+            int length = 64 - leading - trailing;
+            writer.put((0x3u << 12) | (leading << 6) | (length - 1), 14);
+            writer.put(x >> trailing, length);
+            windowLeading = leading;
+            windowTrailing = trailing;
+        }
+    }
+    return writer.flush();
+}
+
+} // namespace
+
+void WaveformCodec::encode(const double* values, std::size_t count, std::vector<unsigned char>& out) {
+    if (count == 0) return;
+
+    // Predictor byte, first value, then at most 2 + 12 + 64 bits per value
+    std::size_t start = out.size();
+    out.resize(start + 1 + 8 + ((count - 1) * 78 + 7) / 8);
+    unsigned char* end = encodeWith(choosePredictor(values, count), values, count, out.data() + start);
+    out.resize(end - out.data());
+}
+
+bool WaveformCodec::decode(const unsigned char* data, std::size_t bytes, std::size_t count, double* out) {
+    if (count == 0) return true;
+    if (bytes < 1 || data[0] > LINEAR) return false;
+
+    Predictor predictor = static_cast<Predictor>(data[0]);
+    BitReader reader(data + 1, bytes - 1);
+    out[0] = valueOf(reader.get(64));
+
+    int windowLeading = -1;
+    int windowTrailing = 0;
+    for (std::size_t i = 1; i < count; i++) {
+        std::uint64_t x = 0;
+        if (reader.get(1)) {
+            if (reader.get(1) == 0) {
+                if (windowLeading < 0) return false;
+                x = reader.get(64 - windowLeading - windowTrailing) << windowTrailing;
+            } else {
+                int leading = static_cast<int>(reader.get(6));
+                int length = static_cast<int>(reader.get(6)) + 1;
+                if (leading + length > 64) return false;
+                windowLeading = leading;
+                windowTrailing = 64 - leading - length;
+                x = reader.get(length) << windowTrailing;
+            }
+        }
+        out[i] = valueOf(bitsOf(predict(predictor, out, i)) ^ x);
+        if (reader.overrun) return false;
+    }
+    return !reader.overrun;
+}
@@ -0,0 +1,29 @@
+#ifndef WAVEFORM_CODEC_H
+#define WAVEFORM_CODEC_H
+
+#include <cstddef>
+#include <vector>
+
+// Lossless compression of one column segment of samples, after Gorilla
+// (Pelkonen et al., VLDB 2015). Each value is predicted from the ones
+// before it and only the XOR of its bits with the prediction is stored:
+//
+//   '0'                               same bits as predicted
+//   '10' + meaningful bits            XOR fits the previous bit window
+//   '11' + 6-bit leading zeros + 6-bit length - 1 + meaningful bits
+//
+// A segment starts with one predictor byte (previous value, or linear
+// extrapolation from the last two, which suits ramps and the time column),
+// chosen per segment by the bits it would take, then the first value in
+// 64 bits. Segments decode on their own, so a chunk of one signal can be
+// read without touching any other.
+namespace WaveformCodec {
+    // Appends the encoding of values[0, count) to out
+    void encode(const double* values, std::size_t count, std::vector<unsigned char>& out);
+
+    // Decodes count values from the bytes of one segment. Returns false if
+    // the segment is shorter than its contents claim.
+    bool decode(const unsigned char* data, std::size_t bytes, std::size_t count, double* out);
+}
+
+#endif
@@ -0,0 +1,290 @@
+#include "waveform_file.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include "simulation/waveform_codec.h"
+#include "simulation/waveform_store.h"
+
+namespace {
+
+template <typename T>
+void put(unsigned char* at, T value) {
+    std::memcpy(at, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const unsigned char* at) {
+    T value;
+    std::memcpy(&value, at, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+WaveformFileWriter::~WaveformFileWriter() {
+    if (!file) return;
+    try {
+        close();
+    } catch (...) {
+        // A writer left open by an exception still gets its index and
+        // header; a failed final write is only visible to close() callers
+    }
+}
+
+void WaveformFileWriter::write(const void* data, std::size_t bytes) {
+    if (bytes > 0 && std::fwrite(data, 1, bytes, file) != bytes) {
+        throw std::runtime_error("Cannot write waveform file: " + path);
+    }
+    position += bytes;
+}
+
+void WaveformFileWriter::writeHeader(std::uint64_t chunks, std::uint64_t indexOffset) {
+    unsigned char header[WaveformFormat::headerBytes] = {};
+    std::memcpy(header, WaveformFormat::magic, sizeof(WaveformFormat::magic));
+    put<std::uint32_t>(header + 8, WaveformFormat::version);
+    put<std::uint32_t>(header + 12, WaveformFormat::byteOrderMark);
+    put<std::uint64_t>(header + 16, signals);
+    put<std::uint64_t>(header + 24, rows);
+    put<std::uint64_t>(header + 32, rowsPerChunk);
+    put<std::uint64_t>(header + 40, chunks);
+    put<std::uint64_t>(header + 48, namesOffset);
+    put<std::uint64_t>(header + 56, indexOffset);
+    write(header, sizeof(header));
+}
+
+void WaveformFileWriter::open(const std::string& filename, const std::vector<std::string>& signalNames,
+                              std::size_t chunkRows, bool compressSegments) {
+    if (file) close();
+    if (chunkRows == 0) {
+        throw std::invalid_argument("WaveformFileWriter: rowsPerChunk must be positive");
+    }
+
+    path = filename;
+    file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    signals = signalNames.size();
+    rowsPerChunk = chunkRows;
+    compress = compressSegments;
+    rows = 0;
+    position = 0;
+    index.clear();
+
+    // Placeholder header; close() rewrites it with the final counts
+    writeHeader(0, 0);
+    namesOffset = position;
+    for (const auto& name : signalNames) {
+        std::uint32_t length = static_cast<std::uint32_t>(name.size());
+        write(&length, sizeof(length));
+        write(name.data(), name.size());
+    }
+}
+
+void WaveformFileWriter::writeChunk(const double* data, std::size_t chunkRows, std::size_t stride) {
+    if (chunkRows == 0) return;
+    if (chunkRows > rowsPerChunk || rows % rowsPerChunk != 0) {
+        throw std::logic_error("WaveformFileWriter: only the last chunk may be short");
+    }
+
+    std::uint32_t rawBytes = static_cast<std::uint32_t>(chunkRows * sizeof(double));
+    for (std::size_t c = 0; c <= signals; c++) {
+        const double* column = data + c * stride;
+        if (compress) {
+            packed.clear();
+            WaveformCodec::encode(column, chunkRows, packed);
+            if (packed.size() < rawBytes) {
+                std::uint32_t bytes = static_cast<std::uint32_t>(packed.size());
+                index.push_back({position, bytes, WaveformFormat::XOR_PACKED});
+                write(packed.data(), bytes);
+                continue;
+            }
+        }
+        index.push_back({position, rawBytes, WaveformFormat::RAW_FLOAT64});
+        write(column, rawBytes);
+    }
+    rows += chunkRows;
+}
+
+void WaveformFileWriter::close() {
+    if (!file) return;
+
+    std::uint64_t indexOffset = position;
+    std::vector<unsigned char> entries(index.size() * WaveformFormat::indexEntryBytes);
+    for (std::size_t i = 0; i < index.size(); i++) {
+        unsigned char* entry = entries.data() + i * WaveformFormat::indexEntryBytes;
+        put<std::uint64_t>(entry, index[i].offset);
+        put<std::uint32_t>(entry + 8, index[i].bytes);
+        put<std::uint32_t>(entry + 12, index[i].encoding);
+    }
+    write(entries.data(), entries.size());
+
+    std::uint64_t chunks = (rows + rowsPerChunk - 1) / rowsPerChunk;
+    bool ok = std::fseek(file, 0, SEEK_SET) == 0;
+    if (ok) writeHeader(chunks, indexOffset);
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    if (!ok) {
+        throw std::runtime_error("Cannot write waveform file: " + path);
+    }
+}
+
+void writeWaveformFile(const WaveformStore& store, const std::string& filename, bool compress) {
+    std::vector<std::string> names;
+    for (std::size_t s = 0; s < store.signalCount(); s++) {
+        names.push_back(store.signalName(static_cast<int>(s)));
+    }
+
+    std::size_t block = store.rowsInChunk();
+    WaveformFileWriter writer;
+    writer.open(filename, names, block, compress);
+
+    std::vector<double> buffer((names.size() + 1) * block);
+    for (std::size_t first = 0; first < store.size(); first += block) {
+        std::size_t count = std::min(block, store.size() - first);
+        store.copyTimes(first, count, buffer.data());
+        for (std::size_t s = 0; s < names.size(); s++) {
+            store.copySignal(static_cast<int>(s), first, count, buffer.data() + (s + 1) * block);
+        }
+        writer.writeChunk(buffer.data(), count, block);
+    }
+    writer.close();
+}
+
+void WaveformFileReader::open(const std::string& filename) {
+    file.open(filename);
+    path = filename;
+    names.clear();
+    signalIds.clear();
+    signals = rows = rowsPerChunk = chunks = 0;
+    index = nullptr;
+    cachedChunk = SIZE_MAX;
+
+    auto invalid = [&](const char* what) {
+        file.close();
+        return std::runtime_error("Invalid waveform file " + filename + ": " + what);
+    };
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file.data());
+    std::size_t size = file.size();
+    if (size < WaveformFormat::headerBytes ||
+        std::memcmp(data, WaveformFormat::magic, sizeof(WaveformFormat::magic)) != 0) {
+        throw invalid("not a waveform file");
+    }
+    if (get<std::uint32_t>(data + 8) != WaveformFormat::version) {
+        throw invalid("unsupported version");
+    }
+    if (get<std::uint32_t>(data + 12) != WaveformFormat::byteOrderMark) {
+        throw invalid("unsupported byte order");
+    }
+
+    std::uint64_t signalCount = get<std::uint64_t>(data + 16);
+    std::uint64_t rowCount = get<std::uint64_t>(data + 24);
+    std::uint64_t chunkRows = get<std::uint64_t>(data + 32);
+    std::uint64_t chunkCount = get<std::uint64_t>(data + 40);
+    std::uint64_t namesOffset = get<std::uint64_t>(data + 48);
+    std::uint64_t indexOffset = get<std::uint64_t>(data + 56);
+
+    // Counts come from the file, so nothing below may overflow: chunks are
+    // counted without rowCount + chunkRows - 1, and every name takes at
+    // least its length field, which bounds signalCount by the file size
+    if (chunkRows == 0 || chunkCount != rowCount / chunkRows + (rowCount % chunkRows != 0)) {
+        throw invalid("inconsistent row counts");
+    }
+    if (namesOffset > size || signalCount > (size - namesOffset) / sizeof(std::uint32_t) ||
+        signalCount >= static_cast<std::uint64_t>(INT_MAX)) {
+        throw invalid("truncated signal names");
+    }
+    std::uint64_t columns = signalCount + 1;
+    if (indexOffset > size || chunkCount > (size - indexOffset) / WaveformFormat::indexEntryBytes / columns) {
+        throw invalid("truncated index");
+    }
+
+    std::uint64_t at = namesOffset;
+    for (std::uint64_t s = 0; s < signalCount; s++) {
+        if (at > size || size - at < sizeof(std::uint32_t)) throw invalid("truncated signal names");
+        std::uint32_t length = get<std::uint32_t>(data + at);
+        at += sizeof(std::uint32_t);
+        if (size - at < length) throw invalid("truncated signal names");
+        names.emplace_back(reinterpret_cast<const char*>(data + at), length);
+        if (signalIds.intern(names.back()) != static_cast<int>(s)) throw invalid("duplicate signal name");
+        at += length;
+    }
+
+    // Every segment must lie inside the file and raw ones must hold their
+    // chunk's rows, so reads need no further checks; packed segments are
+    // checked as they are decoded
+    index = data + indexOffset;
+    for (std::uint64_t chunk = 0; chunk < chunkCount; chunk++) {
+        std::uint64_t chunkRowCount = std::min<std::uint64_t>(chunkRows, rowCount - chunk * chunkRows);
+        for (std::uint64_t c = 0; c < columns; c++) {
+            const unsigned char* entry = index + (chunk * columns + c) * WaveformFormat::indexEntryBytes;
+            std::uint64_t offset = get<std::uint64_t>(entry);
+            std::uint32_t bytes = get<std::uint32_t>(entry + 8);
+            std::uint32_t encoding = get<std::uint32_t>(entry + 12);
+            if (offset > size || size - offset < bytes) throw invalid("segment outside the file");
+            if (encoding == WaveformFormat::RAW_FLOAT64) {
+                if (bytes != chunkRowCount * sizeof(double)) throw invalid("segment size mismatch");
+            } else if (encoding != WaveformFormat::XOR_PACKED) {
+                throw invalid("unknown segment encoding");
+            }
+        }
+    }
+
+    signals = static_cast<std::size_t>(signalCount);
+    rows = static_cast<std::size_t>(rowCount);
+    rowsPerChunk = static_cast<std::size_t>(chunkRows);
+    chunks = static_cast<std::size_t>(chunkCount);
+}
+
+void WaveformFileReader::readSegment(std::size_t chunk, std::size_t column, std::size_t first,
+                                     std::size_t count, double* out) const {
+    const unsigned char* entry = index + (chunk * (signals + 1) + column) * WaveformFormat::indexEntryBytes;
+    std::uint64_t offset = get<std::uint64_t>(entry);
+    const unsigned char* samples = reinterpret_cast<const unsigned char*>(file.data()) + offset;
+    if (get<std::uint32_t>(entry + 12) == WaveformFormat::RAW_FLOAT64) {
+        std::memcpy(out, samples + first * sizeof(double), count * sizeof(double));
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cachedChunk != chunk || cachedColumn != column) {
+        std::size_t chunkRows = std::min(rowsPerChunk, rows - chunk * rowsPerChunk);
+        cachedChunk = SIZE_MAX;
+        cachedSegment.resize(chunkRows);
+        if (!WaveformCodec::decode(samples, get<std::uint32_t>(entry + 8), chunkRows, cachedSegment.data())) {
+            throw std::runtime_error("Corrupt waveform segment in " + path);
+        }
+        cachedChunk = chunk;
+        cachedColumn = column;
+    }
+    std::copy(cachedSegment.begin() + first, cachedSegment.begin() + first + count, out);
+}
+
+void WaveformFileReader::copy(std::size_t column, std::size_t first, std::size_t count, double* out) const {
+    if (first > rows || count > rows - first) {
+        throw std::out_of_range("WaveformFileReader: rows out of range");
+    }
+    while (count > 0) {
+        std::size_t chunk = first / rowsPerChunk;
+        std::size_t offset = first % rowsPerChunk;
+        std::size_t n = std::min(count, rowsPerChunk - offset);
+        readSegment(chunk, column, offset, n, out);
+        first += n;
+        count -= n;
+        out += n;
+    }
+}
+
+double WaveformFileReader::time(std::size_t row) const {
+    double value;
+    copy(0, row, 1, &value);
+    return value;
+}
+
+double WaveformFileReader::value(int signal, std::size_t row) const {
+    double result;
+    copy(static_cast<std::size_t>(signal) + 1, row, 1, &result);
+    return result;
+}
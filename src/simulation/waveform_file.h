@@ -0,0 +1,144 @@
+#ifndef WAVEFORM_FILE_H
+#define WAVEFORM_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parser/node_interner.h"
+#include "util/mapped_file.h"
+
+class WaveformStore;
+
+// Binary waveform file (.spw): the WaveformStore layout on disk.
+//
+//   header    64 bytes, see below
+//   names     per signal: u32 length, bytes (time is implicit, column 0)
+//   chunks    per chunk of rowsPerChunk rows, per column (time first):
+//             one contiguous segment of that column's samples
+//   index     per chunk, per column: u64 offset, u32 bytes, u32 encoding
+//
+//   header:   char magic[8] "SPICEWAV", u32 version, u32 byte order mark,
+//             u64 signals, rows, rowsPerChunk, chunks, namesOffset,
+//             indexOffset
+//
+// Everything is little-endian. A segment is raw float64 (encoding 0) or
+// packed with WaveformCodec (encoding 1); the writer packs a segment only
+// when that makes it smaller. Unlike SPICE raw
+// files, which interleave all variables per point, each column of a chunk
+// is contiguous, so one signal can be read without touching the others.
+// The index sits at the end so that files can be written in one streaming
+// pass; the header is patched when the writer closes.
+namespace WaveformFormat {
+    constexpr char magic[8] = {'S', 'P', 'I', 'C', 'E', 'W', 'A', 'V'};
+    constexpr std::uint32_t version = 1;
+    constexpr std::uint32_t byteOrderMark = 0x01020304;
+    constexpr std::size_t headerBytes = 64;
+    constexpr std::size_t indexEntryBytes = 16;
+
+    enum Encoding : std::uint32_t {
+        RAW_FLOAT64 = 0,
+        XOR_PACKED = 1,     // WaveformCodec
+    };
+}
+
+// Streams chunks to a .spw file. Throws std::runtime_error on I/O errors.
+class WaveformFileWriter {
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint32_t bytes;
+        std::uint32_t encoding;
+    };
+
+    std::FILE* file = nullptr;
+    std::string path;
+    std::size_t signals = 0;
+    std::size_t rowsPerChunk = 0;
+    bool compress = true;
+    std::uint64_t rows = 0;
+    std::uint64_t position = 0;
+    std::uint64_t namesOffset = 0;
+    std::vector<IndexEntry> index;
+    std::vector<unsigned char> packed;  // one segment
+
+    void write(const void* data, std::size_t bytes);
+    void writeHeader(std::uint64_t chunks, std::uint64_t indexOffset);
+
+public:
+    WaveformFileWriter() = default;
+    ~WaveformFileWriter();
+
+    WaveformFileWriter(const WaveformFileWriter&) = delete;
+    WaveformFileWriter& operator=(const WaveformFileWriter&) = delete;
+
+    // With compress false every segment is written raw
+    void open(const std::string& filename, const std::vector<std::string>& signalNames,
+              std::size_t rowsPerChunk, bool compress = true);
+
+    // One chunk of rows (rowsPerChunk, fewer only for the last chunk).
+    // Column c (0 = time, then the signals) starts at data + c * stride.
+    void writeChunk(const double* data, std::size_t rows, std::size_t stride);
+
+    // Writes the index and the final header
+    void close();
+
+    bool isOpen() const { return file != nullptr; }
+};
+
+// Writes a whole store to a .spw file
+void writeWaveformFile(const WaveformStore& store, const std::string& filename, bool compress = true);
+
+// Memory-maps a .spw file and serves samples of any signal straight from
+// the mapping; only the pages of the requested column segments are read.
+// Packed segments are decoded whole, and the last one is kept for the next
+// read.
+class WaveformFileReader {
+private:
+    MappedFile file;
+    std::string path;
+    std::size_t signals = 0;
+    std::size_t rows = 0;
+    std::size_t rowsPerChunk = 0;
+    std::size_t chunks = 0;
+    const unsigned char* index = nullptr;
+    std::vector<std::string> names;
+    NodeInterner signalIds;
+
+    // Last packed segment decoded
+    mutable std::mutex cacheMutex;
+    mutable std::vector<double> cachedSegment;
+    mutable std::size_t cachedChunk = SIZE_MAX;
+    mutable std::size_t cachedColumn = 0;
+
+    // Samples [first, first + count) of chunk's column, within the chunk
+    void readSegment(std::size_t chunk, std::size_t column, std::size_t first, std::size_t count,
+                     double* out) const;
+    void copy(std::size_t column, std::size_t first, std::size_t count, double* out) const;
+
+public:
+    WaveformFileReader() = default;
+    explicit WaveformFileReader(const std::string& filename) { open(filename); }
+
+    // Throws std::runtime_error if the file is missing or malformed
+    void open(const std::string& filename);
+
+    std::size_t signalCount() const { return signals; }
+    const std::string& signalName(int signal) const { return names[signal]; }
+    int findSignal(std::string_view name) const { return signalIds.find(name); }
+
+    std::size_t size() const { return rows; }
+    std::size_t rowsInChunk() const { return rowsPerChunk; }
+
+    double time(std::size_t row) const;
+    double value(int signal, std::size_t row) const;
+    void copyTimes(std::size_t first, std::size_t count, double* out) const { copy(0, first, count, out); }
+    void copySignal(int signal, std::size_t first, std::size_t count, double* out) const {
+        copy(signal + 1, first, count, out);
+    }
+};
+
+#endif
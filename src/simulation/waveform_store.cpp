@@ -0,0 +1,240 @@
+#include "waveform_store.h"
+#include <algorithm>
+#include <stdexcept>
+#include "simulation/waveform_codec.h"
+
+namespace {
+
+bool seekFile(std::FILE* file, std::uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+} // namespace
+
+std::size_t WaveformStore::chunkRowsFor(std::size_t columns) {
+    std::size_t fit = targetChunkBytes / (columns * sizeof(double));
+    std::size_t rows = minRowsPerChunk;
+    while (rows * 2 <= fit && rows < maxRowsPerChunk) rows *= 2;
+    return rows;
+}
+
+WaveformStore::WaveformStore(std::size_t rowsPerChunk)
+    : requestedRowsPerChunk(rowsPerChunk), rowsPerChunk(rowsPerChunk > 0 ? rowsPerChunk : minRowsPerChunk) {
+}
+
+WaveformStore::~WaveformStore() {
+    clear();
+}
+
+int WaveformStore::addSignal(std::string_view name) {
+    int existing = signalIds.find(name);
+    if (existing >= 0) return existing;
+    if (rows > 0) {
+        throw std::logic_error("WaveformStore: signals must be added before the first row");
+    }
+    names.emplace_back(name);
+    return signalIds.intern(name);
+}
+
+void WaveformStore::setMemoryBudget(std::size_t bytes, const std::string& spillFile) {
+    memoryBudget = bytes;
+    spillPath = spillFile;
+    spillChunks();
+}
+
+void WaveformStore::append(double time, const double* values) {
+    if (rows == 0) {
+        if (requestedRowsPerChunk == 0) rowsPerChunk = chunkRowsFor(columns());
+        staging.assign(stageRows * columns(), 0.0);
+    }
+    
+    double* row = staging.data() + stagedRows * columns();
+    row[0] = time;
+    std::copy(values, values + signalCount(), row + 1);
+    stagedRows++;
+    rows++;
+    
+    // Flush at stage boundaries and wherever a chunk fills up (rowsPerChunk
+    // need not be a multiple of stageRows)
+    if (stagedRows == stageRows || (rows - stagedRows) % rowsPerChunk + stagedRows == rowsPerChunk) {
+        flushStaging();
+    }
+}
+
+void WaveformStore::flushStaging() {
+    std::size_t committed = rows - stagedRows;
+    std::size_t offset = committed % rowsPerChunk;
+    if (offset == 0) {
+        // The previous chunk is full and may be packed and go to disk
+        if (compress && !chunks.empty()) packChunk(chunks.back());
+        chunks.emplace_back();
+        chunks.back().data.reset(new double[columns() * rowsPerChunk]);
+        residentBytes += chunkBytes();
+        spillChunks();
+    }
+    
+    double* data = chunks.back().data.get() + offset;
+    for (std::size_t c = 0; c < columns(); c++) {
+        double* column = data + c * rowsPerChunk;
+        for (std::size_t r = 0; r < stagedRows; r++) {
+            column[r] = staging[r * columns() + c];
+        }
+    }
+    stagedRows = 0;
+}
+
+void WaveformStore::packChunk(Chunk& chunk) {
+    std::vector<unsigned char> packed;
+    std::vector<std::uint32_t> columnEnd(columns());
+    for (std::size_t c = 0; c < columns(); c++) {
+        WaveformCodec::encode(chunk.data.get() + c * rowsPerChunk, rowsPerChunk, packed);
+        columnEnd[c] = static_cast<std::uint32_t>(packed.size());
+    }
+    if (packed.size() >= chunkBytes()) return;   // Incompressible; keep it raw
+
+    packed.shrink_to_fit();
+    residentBytes += packed.size();
+    residentBytes -= chunkBytes();
+    chunk.packed = std::move(packed);
+    chunk.columnEnd = std::move(columnEnd);
+    chunk.data.reset();
+}
+
+void WaveformStore::spillChunks() {
+    if (memoryBudget == 0) return;
+
+    // Everything but the chunk being filled may be spilled
+    while (firstResident + 1 < chunks.size() && memoryBytes() > memoryBudget) {
+        if (!spillFile) {
+            spillFile = spillPath.empty() ? std::tmpfile() : std::fopen(spillPath.c_str(), "w+b");
+            if (!spillFile) {
+                throw std::runtime_error("Cannot open waveform spill file" +
+                                         (spillPath.empty() ? std::string() : ": " + spillPath));
+            }
+        }
+
+        // Chunks are spilled as stored, packed or raw
+        Chunk& chunk = chunks[firstResident];
+        const void* bytes = chunk.data ? static_cast<const void*>(chunk.data.get()) : chunk.packed.data();
+        std::size_t size = chunk.data ? chunkBytes() : chunk.packed.size();
+        if (!seekFile(spillFile, spillEnd) || std::fwrite(bytes, 1, size, spillFile) != size) {
+            throw std::runtime_error("Cannot write waveform spill file");
+        }
+        chunk.spillOffset = spillEnd;
+        chunk.data.reset();
+        chunk.packed.clear();
+        chunk.packed.shrink_to_fit();
+        residentBytes -= size;
+        spillEnd += size;
+        firstResident++;
+    }
+}
+
+void WaveformStore::readSegment(std::size_t chunk, std::size_t column, std::size_t first,
+                                std::size_t count, double* out) const {
+    std::lock_guard<std::mutex> lock(spillMutex);
+    if (cachedChunk != chunk || cachedColumn != column) {
+        const Chunk& stored = chunks[chunk];
+        cachedChunk = SIZE_MAX;
+        cachedSegment.resize(rowsPerChunk);
+        if (stored.columnEnd.empty()) {
+            // Spilled raw
+            std::uint64_t offset = stored.spillOffset + column * rowsPerChunk * sizeof(double);
+            std::fflush(spillFile);
+            if (!seekFile(spillFile, offset) ||
+                std::fread(cachedSegment.data(), sizeof(double), rowsPerChunk, spillFile) != rowsPerChunk) {
+                throw std::runtime_error("Cannot read waveform spill file");
+            }
+        } else {
+            std::size_t begin = column > 0 ? stored.columnEnd[column - 1] : 0;
+            std::size_t size = stored.columnEnd[column] - begin;
+            const unsigned char* bytes = stored.packed.data() + begin;
+            if (chunk < firstResident) {
+                cachedBytes.resize(size);
+                std::fflush(spillFile);
+                if (!seekFile(spillFile, stored.spillOffset + begin) ||
+                    std::fread(cachedBytes.data(), 1, size, spillFile) != size) {
+                    throw std::runtime_error("Cannot read waveform spill file");
+                }
+                bytes = cachedBytes.data();
+            }
+            if (!WaveformCodec::decode(bytes, size, rowsPerChunk, cachedSegment.data())) {
+                throw std::runtime_error("Corrupt waveform chunk");
+            }
+        }
+        cachedChunk = chunk;
+        cachedColumn = column;
+    }
+    std::copy(cachedSegment.begin() + first, cachedSegment.begin() + first + count, out);
+}
+
+double WaveformStore::at(std::size_t column, std::size_t row) const {
+    std::size_t committed = rows - stagedRows;
+    if (row >= committed) {
+        return staging[(row - committed) * columns() + column];
+    }
+    std::size_t chunk = row / rowsPerChunk;
+    std::size_t offset = row % rowsPerChunk;
+    if (chunks[chunk].data) {
+        return chunks[chunk].data[column * rowsPerChunk + offset];
+    }
+    double value;
+    readSegment(chunk, column, offset, 1, &value);
+    return value;
+}
+
+void WaveformStore::copy(std::size_t column, std::size_t first, std::size_t count, double* out) const {
+    std::size_t committed = rows - stagedRows;
+    while (count > 0 && first < committed) {
+        std::size_t chunk = first / rowsPerChunk;
+        std::size_t offset = first % rowsPerChunk;
+        std::size_t n = std::min({count, rowsPerChunk - offset, committed - first});
+        if (chunks[chunk].data) {
+            const double* segment = chunks[chunk].data.get() + column * rowsPerChunk + offset;
+            std::copy(segment, segment + n, out);
+        } else {
+            readSegment(chunk, column, offset, n, out);
+        }
+        first += n;
+        count -= n;
+        out += n;
+    }
+    for (std::size_t r = 0; r < count; r++) {
+        out[r] = staging[(first + r - committed) * columns() + column];
+    }
+}
+
+std::vector<double> WaveformStore::times() const {
+    std::vector<double> result(rows);
+    copyTimes(0, rows, result.data());
+    return result;
+}
+
+std::vector<double> WaveformStore::signal(int signal) const {
+    std::vector<double> result(rows);
+    copySignal(signal, 0, rows, result.data());
+    return result;
+}
+
+void WaveformStore::clear() {
+    chunks.clear();
+    rows = 0;
+    staging.clear();
+    stagedRows = 0;
+    names.clear();
+    signalIds.clear();
+    firstResident = 0;
+    residentBytes = 0;
+    spillEnd = 0;
+    if (spillFile) {
+        std::fclose(spillFile);
+        spillFile = nullptr;
+        if (!spillPath.empty()) std::remove(spillPath.c_str());
+    }
+    cachedChunk = SIZE_MAX;
+    cachedColumn = SIZE_MAX;
+}
@@ -0,0 +1,132 @@
+#ifndef WAVEFORM_STORE_H
+#define WAVEFORM_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parser/node_interner.h"
+
+// Append-only, column-oriented storage for transient waveforms.
+//
+// Signals (v(1), i(v1), ...) are registered once, before the first row, and
+// interned for lookup by name. Rows are grouped in chunks of rowsPerChunk;
+// inside a chunk each column is contiguous, so reading one signal walks
+// memory linearly and value(signal, row) is two index computations. New
+// rows are staged row-major and transposed into the chunk stageRows at a
+// time, so each column receives whole cache lines rather than one strided
+// store per row.
+//
+// With compression on, each chunk is encoded column by column with
+// WaveformCodec once it is full (unless that would not make it smaller).
+// With a memory budget, full chunks beyond it are written, as stored, to a
+// spill file (an anonymous temporary file unless a path is given). Packed
+// and spilled chunks are read back one column segment at a time. The chunk
+// being filled always stays in memory, uncompressed.
+class WaveformStore {
+public:
+    static constexpr std::size_t targetChunkBytes = 256 * 1024;
+    static constexpr std::size_t minRowsPerChunk = 64;
+    static constexpr std::size_t maxRowsPerChunk = 4096;
+    static constexpr std::size_t stageRows = 8;   // one cache line of doubles
+
+private:
+    struct Chunk {
+        std::unique_ptr<double[]> data;   // columns x rowsPerChunk; null once packed or spilled
+        std::vector<unsigned char> packed;     // encoded columns back to back; empty once spilled
+        std::vector<std::uint32_t> columnEnd;  // end of each encoded column; empty if not packed
+        std::uint64_t spillOffset = 0;
+    };
+
+    std::size_t requestedRowsPerChunk;
+    std::size_t rowsPerChunk;
+    NodeInterner signalIds;               // signal name -> signal index
+    std::vector<std::string> names;       // by signal index, as registered
+    std::vector<Chunk> chunks;
+    std::size_t rows = 0;
+    std::vector<double> staging;          // stageRows x columns, row-major
+    std::size_t stagedRows = 0;           // the last rows, not yet in a chunk
+
+    bool compress = false;
+    std::size_t residentBytes = 0;        // raw and packed samples in memory
+    std::size_t memoryBudget = 0;         // bytes; 0 = unlimited
+    std::string spillPath;
+    std::FILE* spillFile = nullptr;
+    std::uint64_t spillEnd = 0;
+    std::size_t firstResident = 0;        // chunks before this are spilled
+
+    // Last column segment decoded or read back from the spill file
+    mutable std::mutex spillMutex;
+    mutable std::vector<double> cachedSegment;
+    mutable std::vector<unsigned char> cachedBytes;
+    mutable std::size_t cachedChunk = SIZE_MAX;
+    mutable std::size_t cachedColumn = SIZE_MAX;
+
+    std::size_t columns() const { return names.size() + 1; }   // time is column 0
+    std::size_t chunkBytes() const { return columns() * rowsPerChunk * sizeof(double); }
+    void flushStaging();
+    void packChunk(Chunk& chunk);
+    void spillChunks();
+    void readSegment(std::size_t chunk, std::size_t column, std::size_t first, std::size_t count,
+                     double* out) const;
+    double at(std::size_t column, std::size_t row) const;
+    void copy(std::size_t column, std::size_t first, std::size_t count, double* out) const;
+
+public:
+    // Rows per chunk for a row of columns doubles: a power of two keeping
+    // chunks near targetChunkBytes
+    static std::size_t chunkRowsFor(std::size_t columns);
+
+    // rowsPerChunk 0 picks one from the signal count at the first row
+    explicit WaveformStore(std::size_t rowsPerChunk = 0);
+    ~WaveformStore();
+
+    WaveformStore(const WaveformStore&) = delete;
+    WaveformStore& operator=(const WaveformStore&) = delete;
+
+    // Registers a signal and returns its index. Only allowed while the store
+    // has no rows; re-registering a name returns the existing index.
+    int addSignal(std::string_view name);
+    // Index of a signal (case-insensitive), or -1
+    int findSignal(std::string_view name) const { return signalIds.find(name); }
+    const std::string& signalName(int signal) const { return names[signal]; }
+    std::size_t signalCount() const { return names.size(); }
+
+    // Keep at most about this many bytes of samples in memory; full chunks
+    // beyond it go to spillFile (a temporary file if empty). 0 = unlimited.
+    void setMemoryBudget(std::size_t bytes, const std::string& spillFile = "");
+    // Compress chunks that fill up from now on
+    void setCompression(bool enabled) { compress = enabled; }
+
+    // One row: the time and signalCount() values in signal order
+    void append(double time, const double* values);
+
+    std::size_t size() const { return rows; }
+    bool empty() const { return rows == 0; }
+
+    double time(std::size_t row) const { return at(0, row); }
+    double value(int signal, std::size_t row) const { return at(signal + 1, row); }
+
+    // count samples starting at row first into out
+    void copyTimes(std::size_t first, std::size_t count, double* out) const { copy(0, first, count, out); }
+    void copySignal(int signal, std::size_t first, std::size_t count, double* out) const {
+        copy(signal + 1, first, count, out);
+    }
+    std::vector<double> times() const;
+    std::vector<double> signal(int signal) const;
+
+    std::size_t rowsInChunk() const { return rowsPerChunk; }
+    std::size_t chunkCount() const { return chunks.size(); }
+    std::size_t spilledChunks() const { return firstResident; }
+    // Sample bytes currently held in memory, compressed or not
+    std::size_t memoryBytes() const { return residentBytes; }
+
+    // Drops all rows and signals
+    void clear();
+};
+
+#endif
@@ -0,0 +1,242 @@
+#include "waveform_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include "simulation/waveform_store.h"
+#include "util/trace_events.h"
+
+namespace {
+
+// Retries attempt until it succeeds: a few yields, then short sleeps, so a
+// waiting side neither burns a core nor adds much latency
+template <typename Attempt>
+void waitUntil(Attempt attempt) {
+    for (int spins = 0; !attempt(); spins++) {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+void appendNumber(std::string& text, const char* format, double value) {
+    char buffer[352];   // %.6f of the largest double
+    int length = std::snprintf(buffer, sizeof(buffer), format, value);
+    text.append(buffer, std::min<std::size_t>(length, sizeof(buffer) - 1));
+}
+
+} // namespace
+
+TextWaveformSink::TextWaveformSink(const std::string& filename, Format format)
+    : file(new std::ofstream(filename)), out(file.get()), format(std::move(format)) {
+    if (!file->is_open()) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+}
+
+TextWaveformSink::TextWaveformSink(std::ostream& out, Format format)
+    : out(&out), format(std::move(format)) {
+}
+
+void TextWaveformSink::begin(const std::vector<std::string>& signalNames) {
+    rowSize = signalNames.size() + 1;
+    columns.clear();
+    text = format.preamble + format.timeLabel;
+    for (std::size_t s = 0; s < signalNames.size(); s++) {
+        std::string label = format.label ? format.label(signalNames[s]) : signalNames[s];
+        if (label.empty()) continue;
+        text += format.separator;
+        text += label;
+        columns.push_back(s + 1);
+    }
+    text += '\n';
+    out->write(text.data(), text.size());
+}
+
+void TextWaveformSink::write(const double* rows, std::size_t count) {
+    const bool fixed = format.numbers == NumberStyle::FIXED;
+    const char* timeFormat = fixed ? "%.6e" : "%.9g";
+    const char* valueFormat = fixed ? "%.6f" : "%.9g";
+
+    text.clear();
+    for (std::size_t r = 0; r < count; r++) {
+        const double* row = rows + r * rowSize;
+        appendNumber(text, timeFormat, row[0]);
+        for (std::size_t column : columns) {
+            text += format.separator;
+            appendNumber(text, valueFormat, row[column]);
+        }
+        text += '\n';
+    }
+    out->write(text.data(), text.size());
+    if (!*out) {
+        throw std::runtime_error("Cannot write waveform text output");
+    }
+}
+
+void TextWaveformSink::finish() {
+    out->flush();
+    if (file) file->close();
+    if (!*out) {
+        throw std::runtime_error("Cannot write waveform text output");
+    }
+}
+
+void BinaryWaveformSink::begin(const std::vector<std::string>& signalNames) {
+    columns = signalNames.size() + 1;
+    rowsPerChunk = WaveformStore::chunkRowsFor(columns);
+    chunk.assign(columns * rowsPerChunk, 0.0);
+    rows = 0;
+    if (!rename) {
+        writer.open(filename, signalNames, rowsPerChunk, compress);
+        return;
+    }
+    std::vector<std::string> names;
+    names.reserve(signalNames.size());
+    for (const auto& name : signalNames) names.push_back(rename(name));
+    writer.open(filename, names, rowsPerChunk, compress);
+}
+
+void BinaryWaveformSink::write(const double* data, std::size_t count) {
+    for (std::size_t r = 0; r < count; r++) {
+        const double* row = data + r * columns;
+        for (std::size_t c = 0; c < columns; c++) {
+            chunk[c * rowsPerChunk + rows] = row[c];
+        }
+        if (++rows == rowsPerChunk) flush();
+    }
+}
+
+void BinaryWaveformSink::flush() {
+    writer.writeChunk(chunk.data(), rows, rowsPerChunk);
+    rows = 0;
+}
+
+void BinaryWaveformSink::finish() {
+    if (rows > 0) flush();
+    writer.close();
+}
+
+void writeWaveforms(const WaveformStore& store, WaveformSink& sink) {
+    std::vector<std::string> names;
+    for (std::size_t s = 0; s < store.signalCount(); s++) {
+        names.push_back(store.signalName(static_cast<int>(s)));
+    }
+    sink.begin(names);
+
+    // Columns come out of the store contiguously and go to the sink as rows
+    const std::size_t block = store.rowsInChunk();
+    const std::size_t columns = names.size() + 1;
+    std::vector<double> columnData(columns * block);
+    std::vector<double> rowData(block * columns);
+    for (std::size_t first = 0; first < store.size(); first += block) {
+        std::size_t count = std::min(block, store.size() - first);
+        store.copyTimes(first, count, columnData.data());
+        for (std::size_t s = 0; s < names.size(); s++) {
+            store.copySignal(static_cast<int>(s), first, count, columnData.data() + (s + 1) * block);
+        }
+        for (std::size_t r = 0; r < count; r++) {
+            for (std::size_t c = 0; c < columns; c++) {
+                rowData[r * columns + c] = columnData[c * block + r];
+            }
+        }
+        sink.write(rowData.data(), count);
+    }
+    sink.finish();
+}
+
+WaveformStream::~WaveformStream() {
+    try {
+        close();
+    } catch (...) {
+        // The writer thread is always joined; a sink error it raised is
+        // dropped here and only rethrown by an explicit close()
+    }
+}
+
+void WaveformStream::open(std::unique_ptr<WaveformSink> output, const std::vector<std::string>& signalNames) {
+    close();
+    output->begin(signalNames);
+    sink = std::move(output);
+
+    rowSize = signalNames.size() + 1;
+    blockRows = WaveformStore::chunkRowsFor(rowSize);
+    for (Block& block : blocks) {
+        block.data.reset(new double[blockRows * rowSize]);
+        block.rows = 0;
+    }
+    current = &blocks[0];
+    for (std::size_t i = 1; i < blockCount; i++) {
+        empty.push(&blocks[i]);
+    }
+    error = nullptr;
+    failed.store(false, std::memory_order_relaxed);
+    writer = std::thread(&WaveformStream::run, this);
+}
+
+void WaveformStream::append(double time, const double* values) {
+    // After a write error the rest of the run is dropped; close() reports it
+    if (failed.load(std::memory_order_relaxed)) return;
+
+    double* row = current->data.get() + current->rows * rowSize;
+    row[0] = time;
+    std::copy(values, values + rowSize - 1, row + 1);
+    if (++current->rows == blockRows) {
+        send(current);
+        waitUntil([&] { return empty.pop(current); });
+    }
+}
+
+void WaveformStream::send(Block* block) {
+    waitUntil([&] { return filled.push(block); });
+}
+
+void WaveformStream::run() {
+    for (;;) {
+        Block* block = nullptr;
+        waitUntil([&] { return filled.pop(block); });
+        if (!block) break;   // End of stream
+
+        if (!error) {
+            ScopedTraceEvent event("write block", "export", "rows", static_cast<double>(block->rows));
+            try {
+                sink->write(block->data.get(), block->rows);
+            } catch (...) {
+                error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        block->rows = 0;
+        waitUntil([&] { return empty.push(block); });
+    }
+
+    if (!error) {
+        try {
+            sink->finish();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+}
+
+void WaveformStream::close() {
+    if (!isOpen()) return;
+
+    if (current->rows > 0) send(current);
+    current = nullptr;
+    send(nullptr);
+    writer.join();
+
+    // Every block is back in the empty queue; reclaim them for open()
+    Block* block = nullptr;
+    while (empty.pop(block)) {}
+    sink.reset();
+
+    if (error) {
+        std::exception_ptr raised = error;
+        error = nullptr;
+        std::rethrow_exception(raised);
+    }
+}
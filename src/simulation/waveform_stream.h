@@ -0,0 +1,152 @@
+#ifndef WAVEFORM_STREAM_H
+#define WAVEFORM_STREAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "simulation/waveform_file.h"
+#include "util/spsc_queue.h"
+
+class WaveformStore;
+
+// Destination for saved transient rows: a file format, written as rows
+// arrive. Every row holds the time, then one value per signal.
+class WaveformSink {
+public:
+    virtual ~WaveformSink() = default;
+
+    // Once, before any rows, with the signal names in row order
+    virtual void begin(const std::vector<std::string>& signalNames) = 0;
+    // count rows of 1 + signal count doubles, row-major
+    virtual void write(const double* rows, std::size_t count) = 0;
+    // After the last row
+    virtual void finish() = 0;
+};
+
+// Delimited text: optional preamble lines, a header, then one line per row
+class TextWaveformSink : public WaveformSink {
+public:
+    enum class NumberStyle {
+        FIXED,      // time %.6e, values %.6f
+        GENERAL,    // everything %.9g
+    };
+
+    struct Format {
+        std::string preamble;          // written as is, before the header
+        std::string timeLabel = "Time";
+        char separator = ',';
+        NumberStyle numbers = NumberStyle::FIXED;
+        // Header label of a signal, or empty to leave its column out
+        std::function<std::string(const std::string& signal)> label;
+    };
+
+private:
+    std::unique_ptr<std::ofstream> file;
+    std::ostream* out;
+    Format format;
+    std::vector<std::size_t> columns;  // row offsets of the written signals
+    std::size_t rowSize = 0;
+    std::string text;                  // one block, formatted
+
+public:
+    // Throws std::runtime_error if the file cannot be created
+    TextWaveformSink(const std::string& filename, Format format);
+    // out must outlive the sink
+    TextWaveformSink(std::ostream& out, Format format);
+
+    void begin(const std::vector<std::string>& signalNames) override;
+    void write(const double* rows, std::size_t count) override;
+    void finish() override;
+};
+
+// Binary .spw file (see waveform_file.h); rows are regrouped into chunks
+class BinaryWaveformSink : public WaveformSink {
+public:
+    // Name stored for a signal; every signal is written, so names must
+    // stay unique
+    using Rename = std::function<std::string(const std::string& signal)>;
+
+private:
+    std::string filename;
+    Rename rename;
+    bool compress;
+    WaveformFileWriter writer;
+    std::vector<double> chunk;         // columns x rowsPerChunk
+    std::size_t columns = 0;
+    std::size_t rowsPerChunk = 0;
+    std::size_t rows = 0;              // in chunk
+
+    void flush();
+
+public:
+    // With compress false every segment is written raw
+    explicit BinaryWaveformSink(std::string filename, Rename rename = nullptr, bool compress = true)
+        : filename(std::move(filename)), rename(std::move(rename)), compress(compress) {}
+
+    void begin(const std::vector<std::string>& signalNames) override;
+    void write(const double* rows, std::size_t count) override;
+    void finish() override;
+};
+
+// Writes a stored run to a sink, a chunk of rows at a time
+void writeWaveforms(const WaveformStore& store, WaveformSink& sink);
+
+// Moves rows from the thread producing them to a writer thread that feeds
+// a sink. Rows are collected into fixed-size blocks; full blocks travel to
+// the writer through one lock-free queue and come back empty through
+// another. At most blockCount blocks exist, so memory stays bounded however
+// long the run; if the writer falls behind, append() waits for a block.
+class WaveformStream {
+public:
+    static constexpr std::size_t blockCount = 4;
+
+private:
+    struct Block {
+        std::unique_ptr<double[]> data;
+        std::size_t rows = 0;
+    };
+
+    std::unique_ptr<WaveformSink> sink;
+    std::size_t rowSize = 0;
+    std::size_t blockRows = 0;
+    Block blocks[blockCount];
+    Block* current = nullptr;
+    // Capacity above blockCount leaves room for the end-of-stream null
+    SPSCQueue<Block*, 2 * blockCount> filled;
+    SPSCQueue<Block*, 2 * blockCount> empty;
+    std::thread writer;
+    std::exception_ptr error;          // from the sink; read after join
+    std::atomic<bool> failed{false};
+
+    void run();
+    void send(Block* block);
+
+public:
+    WaveformStream() = default;
+    ~WaveformStream();
+
+    WaveformStream(const WaveformStream&) = delete;
+    WaveformStream& operator=(const WaveformStream&) = delete;
+
+    // Calls sink->begin() here, so that errors opening the output are
+    // thrown to the caller, then starts the writer thread
+    void open(std::unique_ptr<WaveformSink> sink, const std::vector<std::string>& signalNames);
+
+    // One row: the time and a value per signal. Producer thread only.
+    void append(double time, const double* values);
+
+    // Hands over the last rows, waits for the writer and finishes the
+    // sink. Rethrows the first error the sink raised.
+    void close();
+
+    bool isOpen() const { return writer.joinable(); }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "simulation_worker.h"
+#include "util/log.h"
+
+SimulationWorker::~SimulationWorker() {
+    cancel();
+    join();
+}
+
+void SimulationWorker::join() {
+    if (thread.joinable()) thread.join();
+}
+
+bool SimulationWorker::start(const std::string& netlist, bool runDC, const std::string& transientExport) {
+    return launch(nullptr, netlist, runDC, transientExport);
+}
+
+bool SimulationWorker::start(std::unique_ptr<SPICEParser> circuit, bool runDC, const std::string& transientExport) {
+    return launch(std::move(circuit), "", runDC, transientExport);
+}
+
+bool SimulationWorker::launch(std::unique_ptr<SPICEParser> circuit, const std::string& netlist, bool runDC,
+                              const std::string& transientExport) {
+    if (busy()) return false;
+    join();
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        finished.reset();
+    }
+    state.reset();
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&SimulationWorker::run, this, std::move(circuit), netlist, runDC, transientExport);
+    return true;
+}
+
+void SimulationWorker::run(std::unique_ptr<SPICEParser> circuit, std::string netlist, bool runDC,
+                           std::string transientExport) {
+    auto result = std::make_unique<SimulationResult>();
+
+    try {
+        if (circuit) {
+            result->parser = std::move(circuit);
+        } else {
+            result->parser = std::make_unique<SPICEParser>();
+            result->parser->setRunAnalyses(false);
+            result->parser->parseString(netlist);
+        }
+
+        const auto& elements = result->parser->getElements();
+        int numNodes = result->parser->getNumNodes();
+
+        if (elements.empty()) {
+            result->errors.push_back("No circuit elements found.");
+        } else {
+            if (runDC) {
+                result->dc = std::make_unique<DCAnalysis>(elements, numNodes);
+                result->dc->solve();
+                if (!result->dc->hasSolution()) {
+                    result->errors.push_back("DC analysis failed - singular matrix");
+                }
+            }
+
+            const TransientSettings* settings = result->parser->getTransientSettings();
+            if (settings && !state.cancelled()) {
+                result->transient = std::make_unique<TransientAnalysis>(elements, numNodes, *settings);
+                result->transient->setSaveSettings(result->parser->getSaveSettings());
+                if (!transientExport.empty()) {
+                    result->transient->streamExport(transientExport);
+                }
+                result->transient->setProgress(&state);
+                result->transient->solve();
+                result->transient->setProgress(nullptr);
+                result->cancelled = result->transient->wasCancelled();
+                if (!result->transient->hasInitialConditions()) {
+                    result->errors.push_back("Transient analysis failed - no initial conditions (singular matrix)");
+                } else if (result->transient->getStats().rejectedSteps > 0) {
+                    result->errors.push_back("Transient analysis failed - singular matrix");
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        SPICE_LOG_ERROR(General, "Simulation error: " << e.what());
+        result->errors.push_back("Simulation error: " + std::string(e.what()));
+    }
+    result->cancelled = result->cancelled || state.cancelled();
+
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        finished = std::move(result);
+    }
+    running.store(false, std::memory_order_release);
+}
+
+std::unique_ptr<SimulationResult> SimulationWorker::takeResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return std::move(finished);
+}
@@ -0,0 +1,71 @@
+#ifndef SIMULATION_WORKER_H
+#define SIMULATION_WORKER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "parser/spice_parser.h"
+#include "simulation/simulation_progress.h"
+
+// Everything one run produced. The analyses reference the parser's element
+// list, so the parser lives here too; the whole object is handed to the
+// caller by pointer, without copying any waveforms.
+struct SimulationResult {
+    std::unique_ptr<SPICEParser> parser;
+    std::unique_ptr<DCAnalysis> dc;                 // null unless DC was run
+    std::unique_ptr<TransientAnalysis> transient;   // null unless .tran was given
+    std::vector<std::string> errors;
+    bool cancelled = false;
+};
+
+// Runs one netlist at a time on a background thread, so a GUI keeps
+// rendering while it simulates.
+//
+//   worker.start(netlist, true);     // or a circuit built with loadCircuit
+//   ... each frame: show worker.progress(), maybe worker.cancel() ...
+//   if (auto result = worker.takeResult()) { ... }
+class SimulationWorker {
+private:
+    std::thread thread;
+    SimulationProgress state;
+    std::atomic<bool> running{false};
+    std::mutex resultMutex;
+    std::unique_ptr<SimulationResult> finished;
+
+    void run(std::unique_ptr<SPICEParser> circuit, std::string netlist, bool runDC, std::string transientExport);
+    bool launch(std::unique_ptr<SPICEParser> circuit, const std::string& netlist, bool runDC, const std::string& transientExport);
+    void join();
+
+public:
+    SimulationWorker() = default;
+    ~SimulationWorker();
+
+    SimulationWorker(const SimulationWorker&) = delete;
+    SimulationWorker& operator=(const SimulationWorker&) = delete;
+
+    // Parses the netlist and runs the DC operating point (if runDC) and the
+    // transient analysis its .tran command requests. Unless transientExport
+    // is empty, the transient results are written to it (binary if it ends
+    // in .spw, CSV otherwise) while the run goes; a cancelled run leaves
+    // the points computed so far. Returns false while a previous run is
+    // still going.
+    bool start(const std::string& netlist, bool runDC, const std::string& transientExport = "");
+
+    // Same, for a circuit already loaded into a parser (loadCircuit and the
+    // analysis setters), which skips netlist text altogether
+    bool start(std::unique_ptr<SPICEParser> circuit, bool runDC, const std::string& transientExport = "");
+
+    // Stops the transient loop before its next time step
+    void cancel() { state.requestCancel(); }
+
+    bool busy() const { return running.load(std::memory_order_acquire); }
+    const SimulationProgress& progress() const { return state; }
+
+    // The finished run, once; null while running or if already taken
+    std::unique_ptr<SimulationResult> takeResult();
+};
+
+#endif
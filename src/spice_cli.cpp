@@ -0,0 +1,494 @@
+/**
+ * Batch front end: parses netlists and runs their analyses without the GUI.
+ *
+ * Usage: spice-cli [options] netlist...
+ *
+ * Each netlist runs the analyses its .op/.dc and .tran commands request (a
+ * DC operating point if it has none). Results go to stdout in input order,
+ * or with --output to <dir>/<netlist>.op.<ext> and <dir>/<netlist>.tran.<ext>.
+ * The binary format (--format bin, which needs --output) writes transient
+ * waveforms as .spw files; operating points are then written as CSV.
+ * Transient files other than JSON are written on a separate thread while the
+ * analysis runs, without keeping the waveforms in memory: --max-memory then
+ * has no effect, and --compress only packs .spw files.
+ * With --threads N, up to N netlists are simulated concurrently; with
+ * --parse-threads N, each large netlist is parsed on N threads.
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "parser/spice_parser.h"
+#include "simulation/waveform_stream.h"
+#include "util/log.h"
+#include "util/perf_stats.h"
+#include "util/trace_events.h"
+
+namespace {
+
+enum class OutputFormat { TEXT, CSV, JSON, BINARY };
+
+struct Options {
+    OutputFormat format = OutputFormat::TEXT;
+    std::string outputDir;
+    unsigned threads = 1;
+    int parseThreads = 1;
+    size_t maxMemoryMB = 0;
+    bool compress = false;
+    bool stats = false;
+    bool verbose = false;
+    std::string traceFile;
+    std::vector<std::string> netlists;
+};
+
+struct Job {
+    std::string netlist;
+    std::string output;      // rendered results when writing to stdout
+    std::string error;
+    PerfStats stats;
+};
+
+const char* extension(OutputFormat format) {
+    switch (format) {
+        case OutputFormat::CSV: return "csv";
+        case OutputFormat::JSON: return "json";
+        case OutputFormat::BINARY: return "spw";
+        case OutputFormat::TEXT: break;
+    }
+    return "txt";
+}
+
+std::string formatValue(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+std::string quoted(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+// v(name) for every non-ground node, indexed by node number
+std::vector<std::string> nodeLabels(const SPICEParser& parser) {
+    const NodeInterner& nodes = parser.getNodes();
+    std::vector<std::string> labels(nodes.size());
+    for (size_t id = 1; id < nodes.size(); id++) {
+        labels[id] = "v(" + std::string(nodes.name(static_cast<int>(id))) + ")";
+    }
+    return labels;
+}
+
+std::vector<std::string> voltageSources(const SPICEParser& parser) {
+    std::vector<std::string> names;
+    for (const auto& element : parser.getElements()) {
+        if (!element->name.empty() && std::tolower(element->name[0]) == 'v') {
+            names.push_back(element->name);
+        }
+    }
+    return names;
+}
+
+void writeOperatingPoint(std::ostream& out, OutputFormat format, const std::string& netlist,
+                         const SPICEParser& parser, const DCAnalysis& dc) {
+    std::vector<std::string> labels = nodeLabels(parser);
+    std::vector<std::string> sources = voltageSources(parser);
+
+    switch (format) {
+        case OutputFormat::TEXT:
+            out << "* " << netlist << ": operating point\n";
+            for (int node = 1; node < parser.getNumNodes(); node++) {
+                out << labels[node] << " = " << formatValue(dc.getNodeVoltage(node)) << " V\n";
+            }
+            for (const auto& name : sources) {
+                out << "i(" << name << ") = " << formatValue(dc.getVoltagSourceCurrent(name)) << " A\n";
+            }
+            break;
+        case OutputFormat::BINARY:  // operating points have no binary form
+        case OutputFormat::CSV:
+            out << "signal,value\n";
+            for (int node = 1; node < parser.getNumNodes(); node++) {
+                out << labels[node] << ',' << formatValue(dc.getNodeVoltage(node)) << '\n';
+            }
+            for (const auto& name : sources) {
+                out << "i(" << name << ")," << formatValue(dc.getVoltagSourceCurrent(name)) << '\n';
+            }
+            break;
+        case OutputFormat::JSON:
+            out << "{\"netlist\": " << quoted(netlist) << ", \"analysis\": \"op\", \"signals\": {";
+            for (int node = 1; node < parser.getNumNodes(); node++) {
+                out << (node > 1 ? ", " : "") << quoted(labels[node]) << ": "
+                    << formatValue(dc.getNodeVoltage(node));
+            }
+            for (size_t i = 0; i < sources.size(); i++) {
+                out << (i > 0 || parser.getNumNodes() > 1 ? ", " : "") << quoted("i(" + sources[i] + ")")
+                    << ": " << formatValue(dc.getVoltagSourceCurrent(sources[i]));
+            }
+            out << "}}\n";
+            break;
+    }
+}
+
+// Column label of a saved transient signal: v(name) for node voltages,
+// i(source) for the currents asked for by name, empty (left out) for
+// currents saved only through "all"
+std::function<std::string(const std::string&)> transientLabels(const SPICEParser& parser,
+                                                                const SaveSettings& saves) {
+    return [labels = nodeLabels(parser), currents = saves.currents](const std::string& signal) -> std::string {
+        if (signal.compare(0, 2, "v(") == 0) {
+            return labels[std::strtoul(signal.c_str() + 2, nullptr, 10)];
+        }
+        for (const auto& name : currents) {
+            std::string requested = "i(" + name + ")";
+            if (std::equal(requested.begin(), requested.end(), signal.begin(), signal.end(),
+                           [](char a, char b) { return std::tolower(a) == std::tolower(b); })) {
+                return signal;
+            }
+        }
+        return "";
+    };
+}
+
+TextWaveformSink::Format transientTextFormat(OutputFormat format, const std::string& netlist,
+                                             const SPICEParser& parser, const SaveSettings& saves) {
+    TextWaveformSink::Format text;
+    if (format == OutputFormat::TEXT) text.preamble = "* " + netlist + ": transient\n";
+    text.timeLabel = "time";
+    text.separator = format == OutputFormat::CSV ? ',' : ' ';
+    text.numbers = TextWaveformSink::NumberStyle::GENERAL;
+    text.label = transientLabels(parser, saves);
+    return text;
+}
+
+void writeTransient(std::ostream& out, OutputFormat format, const std::string& netlist,
+                    const SPICEParser& parser, const TransientAnalysis& transient) {
+    const WaveformStore& waveforms = transient.getWaveforms();
+
+    if (format != OutputFormat::JSON) {
+        TextWaveformSink sink(out, transientTextFormat(format, netlist, parser, transient.getSaveSettings()));
+        writeWaveforms(waveforms, sink);
+        return;
+    }
+
+    // Samples are copied out a chunk of rows at a time, so results larger
+    // than memory (spilled by --max-memory) are streamed, not materialized
+    const size_t rows = waveforms.size();
+    const size_t block = waveforms.rowsInChunk();
+    std::vector<double> buffer(block);
+    auto writeColumn = [&](auto copyBlock) {
+        for (size_t first = 0; first < rows; first += block) {
+            size_t count = std::min(block, rows - first);
+            copyBlock(first, count, buffer.data());
+            for (size_t k = 0; k < count; k++) out << (first + k ? ", " : "") << formatValue(buffer[k]);
+        }
+    };
+    out << "{\"netlist\": " << quoted(netlist) << ", \"analysis\": \"tran\", \"time\": [";
+    writeColumn([&](size_t first, size_t count, double* data) { waveforms.copyTimes(first, count, data); });
+    out << "], \"signals\": {";
+    auto label = transientLabels(parser, transient.getSaveSettings());
+    bool firstSignal = true;
+    for (size_t signal = 0; signal < waveforms.signalCount(); signal++) {
+        std::string name = label(waveforms.signalName(static_cast<int>(signal)));
+        if (name.empty()) continue;
+        out << (firstSignal ? "" : ", ") << quoted(name) << ": [";
+        firstSignal = false;
+        writeColumn([&](size_t first, size_t count, double* data) {
+            waveforms.copySignal(static_cast<int>(signal), first, count, data);
+        });
+        out << "]";
+    }
+    out << "}}\n";
+}
+
+// Results go to a file per analysis with --output, else into the job's
+// buffer so that concurrent jobs print in input order
+class ResultSink {
+private:
+    const Options& options;
+    Job& job;
+    std::ostringstream buffer;
+
+public:
+    ResultSink(const Options& options, Job& job) : options(options), job(job) {}
+    ~ResultSink() { job.output += buffer.str(); }
+
+    std::filesystem::path outputPath(const char* analysis, OutputFormat format) const {
+        return std::filesystem::path(options.outputDir) /
+            (std::filesystem::path(job.netlist).stem().string() + "." + analysis + "." + extension(format));
+    }
+
+    // Tables in the text format closest to the requested one
+    OutputFormat textFormat() const {
+        return options.format == OutputFormat::BINARY ? OutputFormat::CSV : options.format;
+    }
+
+    template <typename Writer>
+    bool write(const char* analysis, Writer&& writer) {
+        ScopedPhaseTimer timer(job.stats, PerfPhase::Export);
+        if (options.outputDir.empty()) {
+            writer(buffer, textFormat());
+            return true;
+        }
+        std::filesystem::path path = outputPath(analysis, textFormat());
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            job.error = "cannot write " + path.string();
+            return false;
+        }
+        writer(file, textFormat());
+        return true;
+    }
+
+    // Row formats go to their file while the analysis runs, without
+    // keeping the rows in memory; JSON is written by column afterwards
+    bool streams() const {
+        return !options.outputDir.empty() && options.format != OutputFormat::JSON;
+    }
+
+    bool stream(const char* analysis, TransientAnalysis& transient, const SPICEParser& parser,
+                const SaveSettings& saves) {
+        std::filesystem::path path = outputPath(analysis, options.format);
+        try {
+            if (options.format == OutputFormat::BINARY) {
+                // Node voltages by netlist name, as in the text formats, but
+                // keeping every column
+                auto label = transientLabels(parser, saves);
+                auto rename = [label](const std::string& signal) {
+                    std::string name = label(signal);
+                    return name.empty() ? signal : name;
+                };
+                transient.setResultStream(std::make_unique<BinaryWaveformSink>(
+                    path.string(), rename, options.compress), false);
+            } else {
+                transient.setResultStream(std::make_unique<TextWaveformSink>(
+                    path.string(), transientTextFormat(options.format, job.netlist, parser, saves)), false);
+            }
+        } catch (const std::runtime_error&) {
+            job.error = "cannot write " + path.string();
+            return false;
+        }
+        return true;
+    }
+};
+
+void runJob(const Options& options, Job& job) {
+    try {
+        SPICEParser parser;
+        parser.setRunAnalyses(false);
+        parser.setParseThreads(options.parseThreads);
+        parser.parseFile(job.netlist);
+        job.stats.merge(parser.getStats());
+
+        if (parser.getElements().empty()) {
+            job.error = "no circuit elements";
+            return;
+        }
+
+        const auto& elements = parser.getElements();
+        ResultSink sink(options, job);
+
+        if (parser.hasDCAnalysis() || !parser.getTransientSettings()) {
+            DCAnalysis dc(elements, parser.getNumNodes());
+            dc.solve();
+            job.stats.merge(dc.getStats());
+            if (!dc.hasSolution()) {
+                job.error = "DC analysis failed (singular matrix)";
+                return;
+            }
+            if (!sink.write("op", [&](std::ostream& out, OutputFormat format) {
+                    writeOperatingPoint(out, format, job.netlist, parser, dc);
+                })) {
+                return;
+            }
+        }
+
+        if (const TransientSettings* settings = parser.getTransientSettings()) {
+            TransientAnalysis transient(elements, parser.getNumNodes(), *settings);
+            SaveSettings saves = parser.getSaveSettings();
+            transient.setSaveSettings(saves);
+            transient.setResultMemoryBudget(options.maxMemoryMB << 20);
+            transient.setResultCompression(options.compress);
+            if (sink.streams() && !sink.stream("tran", transient, parser, saves)) {
+                return;
+            }
+            transient.solve();
+            if (!transient.hasInitialConditions()) {
+                job.error = "transient analysis failed (no initial conditions)";
+            } else if (transient.getStats().rejectedSteps > 0) {
+                job.error = "transient analysis failed";
+            }
+            if (!sink.streams() && transient.hasInitialConditions()) {
+                sink.write("tran", [&](std::ostream& out, OutputFormat format) {
+                    writeTransient(out, format, job.netlist, parser, transient);
+                });
+            }
+            job.stats.merge(transient.getStats());
+        }
+    } catch (const std::exception& e) {
+        job.error = e.what();
+    }
+}
+
+void printStats(const Job& job) {
+    const PerfStats& s = job.stats;
+    std::fprintf(stderr, "%s: total %.3f ms", job.netlist.c_str(), 1e3 * s.totalSeconds());
+    for (int i = 0; i < PerfStats::phaseCount; i++) {
+        PerfPhase phase = static_cast<PerfPhase>(i);
+        std::fprintf(stderr, ", %s %.3f", perfPhaseName(phase), 1e3 * s.phaseSeconds(phase));
+    }
+    std::fprintf(stderr, "\n  %d unknowns, %lld nonzeros, %lld factor nonzeros (fill %lld), "
+                         "%lld factorizations, %lld steps, %lld linearizations, %lld rejected\n",
+                 s.matrixSize, s.matrixNonZeros, s.factorNonZeros, s.fillIn, s.factorizations,
+                 s.timeSteps, s.linearizations, s.rejectedSteps);
+}
+
+int usage(int status) {
+    std::fprintf(status ? stderr : stdout,
+        "usage: spice-cli [options] netlist...\n"
+        "  -f, --format FORMAT         text, csv, json or bin (default text); bin needs -o\n"
+        "  -o, --output DIR            write <netlist>.<analysis>.<ext> files into DIR\n"
+        "  -j, --threads N             simulate up to N netlists at once (0: one per core)\n"
+        "  -p, --parse-threads N       parse each large netlist on N threads (0: one per core)\n"
+        "  -m, --max-memory MB         keep at most MB of waveforms in memory, spill the rest\n"
+        "                              (results written with -o in text, csv or bin are\n"
+        "                              streamed, not kept)\n"
+        "  -z, --compress              keep waveforms compressed in memory and when spilled,\n"
+        "                              and pack .spw files\n"
+        "  -s, --stats                 print phase timings and solver counters to stderr\n"
+        "  -v, --verbose               log analysis progress\n"
+        "      --trace FILE            write a Chrome trace-event timeline to FILE\n"
+        "  -h, --help                  show this message\n");
+    return status;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg == "-f" || arg == "--format") {
+            const char* format = value();
+            if (!format) return false;
+            std::string name = format;
+            if (name == "text") options.format = OutputFormat::TEXT;
+            else if (name == "csv") options.format = OutputFormat::CSV;
+            else if (name == "json") options.format = OutputFormat::JSON;
+            else if (name == "bin") options.format = OutputFormat::BINARY;
+            else return false;
+        } else if (arg == "-o" || arg == "--output") {
+            const char* dir = value();
+            if (!dir) return false;
+            options.outputDir = dir;
+        } else if (arg == "-j" || arg == "--threads") {
+            const char* count = value();
+            if (!count) return false;
+            options.threads = static_cast<unsigned>(std::strtoul(count, nullptr, 10));
+        } else if (arg == "-p" || arg == "--parse-threads") {
+            const char* count = value();
+            if (!count) return false;
+            options.parseThreads = static_cast<int>(std::strtol(count, nullptr, 10));
+        } else if (arg == "-m" || arg == "--max-memory") {
+            const char* megabytes = value();
+            if (!megabytes) return false;
+            options.maxMemoryMB = static_cast<size_t>(std::strtoull(megabytes, nullptr, 10));
+        } else if (arg == "-z" || arg == "--compress") {
+            options.compress = true;
+        } else if (arg == "-s" || arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "--trace") {
+            const char* file = value();
+            if (!file) return false;
+            options.traceFile = file;
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.netlists.push_back(arg);
+        }
+    }
+    if (options.format == OutputFormat::BINARY && options.outputDir.empty()) return false;
+    return !options.netlists.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") return usage(0);
+    }
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) return usage(2);
+
+    // Result tables and per-analysis chatter stay off unless asked for
+    Log::setLevel(options.verbose ? LogLevel::Info : LogLevel::Warning);
+
+    // Streamed transients keep no waveforms in memory
+    if (!options.outputDir.empty() && options.format != OutputFormat::JSON) {
+        if (options.maxMemoryMB > 0) {
+            SPICE_LOG_WARN(General, "--max-memory has no effect: transient results are streamed to files");
+        }
+        if (options.compress && options.format != OutputFormat::BINARY) {
+            SPICE_LOG_WARN(General, "--compress has no effect: transient results are streamed to "
+                           << extension(options.format) << " files");
+        }
+    }
+
+    if (!options.outputDir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(options.outputDir, error);
+    }
+    if (!options.traceFile.empty()) TraceRecorder::start();
+
+    std::vector<Job> jobs(options.netlists.size());
+    for (size_t i = 0; i < jobs.size(); i++) jobs[i].netlist = options.netlists[i];
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(jobs.size()));
+
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i = next++; i < jobs.size(); i = next++) runJob(options, jobs[i]);
+    };
+    if (threads <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+        for (auto& thread : pool) thread.join();
+    }
+
+    if (!options.traceFile.empty()) {
+        TraceRecorder::stop();
+        if (!TraceRecorder::writeJson(options.traceFile)) {
+            std::fprintf(stderr, "cannot write %s\n", options.traceFile.c_str());
+        }
+    }
+
+    int status = 0;
+    for (const Job& job : jobs) {
+        std::cout << job.output;
+        if (options.stats) printStats(job);
+        if (!job.error.empty()) {
+            std::fprintf(stderr, "%s: %s\n", job.netlist.c_str(), job.error.c_str());
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,179 @@
+#include "log.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+std::atomic<bool> consoleOutput{true};
+std::mutex consoleMutex;
+
+// The active ring buffer is published through an atomic pointer; replaced
+// buffers are kept alive until exit so a concurrent writer never touches
+// freed memory.
+std::atomic<LogRingBuffer*> activeRing{nullptr};
+std::mutex ringMutex;
+std::vector<std::unique_ptr<LogRingBuffer>> ringBuffers;
+
+std::int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+static_assert(static_cast<int>(LogCategory::Count) == 7, "one default threshold per category");
+std::atomic<int> Log::thresholds[static_cast<int>(LogCategory::Count)] = {
+    {static_cast<int>(LogLevel::Info)}, {static_cast<int>(LogLevel::Info)},
+    {static_cast<int>(LogLevel::Info)}, {static_cast<int>(LogLevel::Info)},
+    {static_cast<int>(LogLevel::Info)}, {static_cast<int>(LogLevel::Info)},
+    {static_cast<int>(LogLevel::Info)}
+};
+
+const char* logLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "trace";
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Error: return "error";
+        case LogLevel::Off: return "off";
+    }
+    return "?";
+}
+
+const char* logCategoryName(LogCategory category) {
+    switch (category) {
+        case LogCategory::General: return "general";
+        case LogCategory::Parser: return "parser";
+        case LogCategory::DC: return "dc";
+        case LogCategory::Transient: return "transient";
+        case LogCategory::Device: return "device";
+        case LogCategory::Solver: return "solver";
+        case LogCategory::GUI: return "gui";
+        case LogCategory::Count: break;
+    }
+    return "?";
+}
+
+LogRingBuffer::LogRingBuffer(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity) size <<= 1;
+    slots = std::vector<Slot>(size);
+    mask = size - 1;
+}
+
+void LogRingBuffer::push(LogLevel level, LogCategory category, const char* text, std::size_t length) {
+    std::uint64_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[ticket & mask];
+
+    // Claim the slot only from a completed record of an earlier ticket (or
+    // one never written); if it is being written, or a later ticket already
+    // holds it, this record is dropped
+    std::uint64_t writing = 2 * ticket + 1;
+    std::uint64_t state = slot.state.load(std::memory_order_relaxed);
+    do {
+        if ((state & 1) != 0 || state > writing) return;
+    } while (!slot.state.compare_exchange_weak(state, writing, std::memory_order_relaxed));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    length = std::min(length, maxMessageLength);
+    slot.timeNanoseconds.store(nowNanoseconds(), std::memory_order_relaxed);
+    slot.header.store(static_cast<std::uint32_t>(level) |
+                      static_cast<std::uint32_t>(category) << 8 |
+                      static_cast<std::uint32_t>(length) << 16, std::memory_order_relaxed);
+    for (std::size_t word = 0; word * 8 < length; word++) {
+        std::uint64_t packed = 0;
+        std::memcpy(&packed, text + word * 8, std::min<std::size_t>(8, length - word * 8));
+        slot.text[word].store(packed, std::memory_order_relaxed);
+    }
+
+    slot.state.store(writing + 1, std::memory_order_release);
+}
+
+std::vector<LogRingBuffer::Record> LogRingBuffer::snapshot() const {
+    std::vector<Record> records;
+    std::uint64_t end = head.load(std::memory_order_acquire);
+    std::uint64_t begin = end > slots.size() ? end - slots.size() : 0;
+    records.reserve(static_cast<std::size_t>(end - begin));
+
+    char text[textWords * 8];
+    for (std::uint64_t ticket = begin; ticket < end; ticket++) {
+        const Slot& slot = slots[ticket & mask];
+        std::uint64_t before = slot.state.load(std::memory_order_acquire);
+        if (before != 2 * ticket + 2) continue;  // in progress, dropped or overwritten
+
+        std::int64_t time = slot.timeNanoseconds.load(std::memory_order_relaxed);
+        std::uint32_t header = slot.header.load(std::memory_order_relaxed);
+        std::size_t length = std::min<std::size_t>(header >> 16, maxMessageLength);
+        for (std::size_t word = 0; word * 8 < length; word++) {
+            std::uint64_t packed = slot.text[word].load(std::memory_order_relaxed);
+            std::memcpy(text + word * 8, &packed, 8);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.state.load(std::memory_order_relaxed) != before) continue;
+
+        Record record;
+        record.sequence = ticket;
+        record.timeNanoseconds = time;
+        record.level = static_cast<LogLevel>(header & 0xff);
+        record.category = static_cast<LogCategory>((header >> 8) & 0xff);
+        record.message.assign(text, length);
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+void Log::write(LogLevel level, LogCategory category, const std::string& message) {
+    if (LogRingBuffer* ring = activeRing.load(std::memory_order_acquire)) {
+        ring->push(level, category, message.data(), message.size());
+    }
+
+    if (!consoleOutput.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(consoleMutex);
+    if (level >= LogLevel::Warning) {
+        std::cerr << logLevelName(level) << ": " << message << '\n';
+    } else if (level == LogLevel::Info) {
+        std::cout << message << '\n';
+    } else {
+        std::cout << '[' << logLevelName(level) << ' ' << logCategoryName(category) << "] "
+                  << message << '\n';
+    }
+}
+
+void Log::setLevel(LogCategory category, LogLevel level) {
+    thresholds[static_cast<int>(category)].store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void Log::setLevel(LogLevel level) {
+    for (auto& threshold : thresholds) {
+        threshold.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+}
+
+LogLevel Log::level(LogCategory category) {
+    return static_cast<LogLevel>(thresholds[static_cast<int>(category)].load(std::memory_order_relaxed));
+}
+
+void Log::setConsoleOutput(bool enabled) {
+    consoleOutput.store(enabled, std::memory_order_relaxed);
+}
+
+LogRingBuffer& Log::enableRingBuffer(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ringBuffers.push_back(std::make_unique<LogRingBuffer>(capacity));
+    activeRing.store(ringBuffers.back().get(), std::memory_order_release);
+    return *ringBuffers.back();
+}
+
+void Log::disableRingBuffer() {
+    activeRing.store(nullptr, std::memory_order_release);
+}
+
+LogRingBuffer* Log::ringBuffer() {
+    return activeRing.load(std::memory_order_acquire);
+}
@@ -0,0 +1,132 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Leveled, per-category logging.
+//
+//   SPICE_LOG_INFO(Transient, "Matrix size: " << n);
+//   SPICE_TRACE(Device, "Diode " << name << " G=" << g);
+//
+// The message expression is only formatted when the level is enabled for
+// the category, so a disabled call costs one relaxed atomic load. Trace calls
+// are removed at compile time unless SPICE_LOG_ENABLE_TRACE is 1 (CMake
+// option SPICE_TRACE), which is what stamp- and step-level tracing uses.
+//
+// Enumerators are mixed case because DEBUG and ERROR are commonly predefined
+// macros.
+
+#ifndef SPICE_LOG_ENABLE_TRACE
+#define SPICE_LOG_ENABLE_TRACE 0
+#endif
+
+enum class LogLevel : int { Trace, Debug, Info, Warning, Error, Off };
+
+enum class LogCategory : int { General, Parser, DC, Transient, Device, Solver, GUI, Count };
+
+const char* logLevelName(LogLevel level);
+const char* logCategoryName(LogCategory category);
+
+// Fixed-capacity in-memory sink. Writers never block or allocate: each push
+// takes a ticket with one atomic increment, claims the ticket's slot by moving
+// its sequence number from a completed earlier record to "being written", and
+// publishes it with a second store; once full, the oldest records are
+// overwritten. A push whose slot is still being written by a writer a full
+// ring ahead or behind is dropped. snapshot() returns the records that were
+// completely written, oldest first.
+class LogRingBuffer {
+public:
+    static constexpr std::size_t maxMessageLength = 239;
+
+    struct Record {
+        std::uint64_t sequence;
+        std::int64_t timeNanoseconds;   // steady clock
+        LogLevel level;
+        LogCategory category;
+        std::string message;
+    };
+
+    // capacity is rounded up to a power of two
+    explicit LogRingBuffer(std::size_t capacity);
+
+    void push(LogLevel level, LogCategory category, const char* text, std::size_t length);
+    std::vector<Record> snapshot() const;
+
+    std::size_t capacity() const { return slots.size(); }
+    std::uint64_t written() const { return head.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::size_t textWords = (maxMessageLength + 7) / 8;
+
+    // The payload is only accessed through relaxed atomics, ordered by the
+    // fences around the state changes, so a reader racing a writer sees a
+    // changed state rather than a data race
+    struct Slot {
+        // 2 * ticket + 1 while being written, 2 * ticket + 2 once complete
+        std::atomic<std::uint64_t> state{0};
+        std::atomic<std::int64_t> timeNanoseconds{0};
+        std::atomic<std::uint32_t> header{0};    // level, category and length
+        std::atomic<std::uint64_t> text[textWords];
+    };
+
+    std::vector<Slot> slots;
+    std::size_t mask;
+    alignas(64) std::atomic<std::uint64_t> head{0};
+};
+
+class Log {
+public:
+    static bool enabled(LogLevel level, LogCategory category) {
+        return static_cast<int>(level) >=
+               thresholds[static_cast<int>(category)].load(std::memory_order_relaxed);
+    }
+
+    static void write(LogLevel level, LogCategory category, const std::string& message);
+
+    // Minimum level for one category, or for all of them
+    static void setLevel(LogCategory category, LogLevel level);
+    static void setLevel(LogLevel level);
+    static LogLevel level(LogCategory category);
+
+    // Console sink (on by default): Info and below to stdout, warnings and
+    // errors to stderr
+    static void setConsoleOutput(bool enabled);
+
+    // Route records into an in-memory ring buffer in addition to the console
+    // (which can be switched off). Returns the buffer; buffers are never
+    // freed, so a reference stays valid after it is replaced or disabled.
+    static LogRingBuffer& enableRingBuffer(std::size_t capacity);
+    static void disableRingBuffer();
+    static LogRingBuffer* ringBuffer();
+
+private:
+    static std::atomic<int> thresholds[static_cast<int>(LogCategory::Count)];
+};
+
+#define SPICE_LOG(level, category, expr)                                      \
+    do {                                                                      \
+        if (Log::enabled(level, category)) {                                  \
+            std::ostringstream spiceLogStream_;                               \
+            spiceLogStream_ << expr;                                          \
+            Log::write(level, category, spiceLogStream_.str());               \
+        }                                                                     \
+    } while (0)
+
+#define SPICE_LOG_DEBUG(category, expr) SPICE_LOG(LogLevel::Debug, LogCategory::category, expr)
+#define SPICE_LOG_INFO(category, expr) SPICE_LOG(LogLevel::Info, LogCategory::category, expr)
+#define SPICE_LOG_WARN(category, expr) SPICE_LOG(LogLevel::Warning, LogCategory::category, expr)
+#define SPICE_LOG_ERROR(category, expr) SPICE_LOG(LogLevel::Error, LogCategory::category, expr)
+
+#if SPICE_LOG_ENABLE_TRACE
+#define SPICE_TRACE(category, expr) SPICE_LOG(LogLevel::Trace, LogCategory::category, expr)
+#else
+#define SPICE_TRACE(category, expr) do { } while (0)
+#endif
+
+#endif
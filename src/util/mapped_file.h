@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// A whole file mapped read-only into memory. Pages are loaded by the OS as
+// they are touched, so a multi-hundred-MB netlist is neither copied nor
+// read up front. Views into data() stay valid until close() or destruction.
+class MappedFile {
+private:
+    const char* ptr = nullptr;
+    std::size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename) { open(filename); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    void open(const std::string& filename);
+    void close();
+
+    // Hint that the file will be read front to back
+    void adviseSequential();
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return ptr; }
+    std::size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(ptr, length); }
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "perf_stats.h"
+
+const char* perfPhaseName(PerfPhase phase) {
+    switch (phase) {
+        case PerfPhase::Parse: return "parse";
+        case PerfPhase::Setup: return "setup";
+        case PerfPhase::Assembly: return "assembly";
+        case PerfPhase::Factor: return "factor";
+        case PerfPhase::Solve: return "solve";
+        case PerfPhase::Save: return "save";
+        case PerfPhase::Export: return "export";
+        case PerfPhase::Count: break;
+    }
+    return "?";
+}
+
+double PerfStats::totalSeconds() const {
+    double total = 0.0;
+    for (double s : seconds) total += s;
+    return total;
+}
+
+void PerfStats::recordMatrix(int size, long long nonZeros) {
+    matrixSize = size;
+    matrixNonZeros = nonZeros;
+}
+
+void PerfStats::recordFactorization(long long factorNnz) {
+    factorNonZeros = factorNnz;
+    fillIn = factorNnz - matrixNonZeros;
+    factorizations++;
+}
+
+void PerfStats::merge(const PerfStats& other) {
+    for (int i = 0; i < phaseCount; i++) {
+        seconds[i] += other.seconds[i];
+        calls[i] += other.calls[i];
+    }
+    if (other.matrixSize > 0) {
+        matrixSize = other.matrixSize;
+        matrixNonZeros = other.matrixNonZeros;
+        factorNonZeros = other.factorNonZeros;
+        fillIn = other.fillIn;
+    }
+    factorizations += other.factorizations;
+    timeSteps += other.timeSteps;
+    linearizations += other.linearizations;
+    rejectedSteps += other.rejectedSteps;
+}
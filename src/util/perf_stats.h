@@ -0,0 +1,87 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <chrono>
+#include "util/trace_events.h"
+
+// Wall-clock phases of a simulation run
+enum class PerfPhase : int { Parse, Setup, Assembly, Factor, Solve, Save, Export, Count };
+
+const char* perfPhaseName(PerfPhase phase);
+
+// Timers and counters of the most recent run. Per-step phases accumulate,
+// so Assembly, Factor, Solve and Save hold totals over all time steps.
+struct PerfStats {
+    static constexpr int phaseCount = static_cast<int>(PerfPhase::Count);
+
+    double seconds[phaseCount] = {};
+    long long calls[phaseCount] = {};
+
+    int matrixSize = 0;
+    long long matrixNonZeros = 0;
+    long long factorNonZeros = 0;    // nnz(L) + nnz(U), diagonal counted once
+    long long fillIn = 0;            // factorNonZeros - matrixNonZeros
+    long long factorizations = 0;
+    long long timeSteps = 0;
+    // Re-linearizations of the nonlinear devices followed by a solve, one
+    // per nonlinear time step. There is no inner Newton loop yet, so this is
+    // not an iteration count.
+    long long linearizations = 0;
+    long long rejectedSteps = 0;     // steps whose linear solve failed
+
+    void add(PerfPhase phase, double elapsed) {
+        seconds[static_cast<int>(phase)] += elapsed;
+        calls[static_cast<int>(phase)]++;
+    }
+
+    double phaseSeconds(PerfPhase phase) const { return seconds[static_cast<int>(phase)]; }
+    long long phaseCalls(PerfPhase phase) const { return calls[static_cast<int>(phase)]; }
+    double totalSeconds() const;
+
+    // The system about to be factored, then the factors it produced
+    void recordMatrix(int size, long long nonZeros);
+    void recordFactorization(long long factorNnz);
+
+    // Accumulate another run's phases and counters (e.g. parser + analysis)
+    void merge(const PerfStats& other);
+    void reset() { *this = PerfStats(); }
+};
+
+// Adds the time between construction (or restart()) and stop() or
+// destruction to one phase. Costs two steady_clock reads; while a
+// TraceRecorder is running, each interval is also recorded as an event.
+class ScopedPhaseTimer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PerfStats& stats;
+    PerfPhase phase;
+    Clock::time_point start;
+    bool running = true;
+
+public:
+    ScopedPhaseTimer(PerfStats& stats, PerfPhase phase)
+        : stats(stats), phase(phase), start(Clock::now()) {}
+    ~ScopedPhaseTimer() { stop(); }
+
+    ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+    ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+    void stop() {
+        if (!running) return;
+        Clock::time_point end = Clock::now();
+        stats.add(phase, std::chrono::duration<double>(end - start).count());
+        if (TraceRecorder::enabled()) {
+            TraceRecorder::record(perfPhaseName(phase), "phase", start, end);
+        }
+        running = false;
+    }
+
+    void restart() {
+        stop();
+        start = Clock::now();
+        running = true;
+    }
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. push() and pop() never block or allocate: each touches the other
+// side's index once (acquire) and publishes its own (release). Callers that
+// must wait retry with their own backoff.
+template <typename T, std::size_t Capacity>
+class SPSCQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer only; false when full
+    bool push(const T& value) {
+        std::size_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - head.load(std::memory_order_acquire) == Capacity) return false;
+        items[tail & (Capacity - 1)] = value;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only; false when empty
+    bool pop(T& value) {
+        std::size_t head = this->head.load(std::memory_order_relaxed);
+        if (head == tail.load(std::memory_order_acquire)) return false;
+        value = items[head & (Capacity - 1)];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    T items[Capacity] = {};
+    // Each index on its own cache line, so the two threads do not contend
+    alignas(64) std::atomic<std::size_t> head{0};   // next to pop
+    alignas(64) std::atomic<std::size_t> tail{0};   // next to push
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "trace_events.h"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    const char* argName;
+    double argValue;
+    TraceRecorder::Clock::time_point begin;
+    TraceRecorder::Clock::duration duration;
+};
+
+struct ThreadBuffer {
+    int threadId;
+    std::vector<TraceEvent> events;
+    std::size_t dropped = 0;
+};
+
+// Buffers are owned here rather than by their threads so that events of
+// threads that have exited can still be written out.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+TraceRecorder::Clock::time_point epoch = TraceRecorder::Clock::now();
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer->threadId = static_cast<int>(buffers.size());
+        buffer->events.reserve(1024);
+    }
+    return *buffer;
+}
+
+void writeString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+double microseconds(TraceRecorder::Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+} // namespace
+
+std::atomic<bool> TraceRecorder::active{false};
+
+void TraceRecorder::start() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto& buffer : buffers) {
+            buffer->events.clear();
+            buffer->dropped = 0;
+        }
+        epoch = Clock::now();
+    }
+    active.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::stop() {
+    active.store(false, std::memory_order_release);
+}
+
+void TraceRecorder::record(const char* name, const char* category,
+                           Clock::time_point begin, Clock::time_point end,
+                           const char* argName, double argValue) {
+    ThreadBuffer& buffer = localBuffer();
+    if (buffer.events.size() >= maxEventsPerThread) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back({name, category, argName, argValue, begin, end - begin});
+}
+
+std::size_t TraceRecorder::eventCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::size_t count = 0;
+    for (const auto& buffer : buffers) count += buffer->events.size();
+    return count;
+}
+
+std::size_t TraceRecorder::droppedCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::size_t count = 0;
+    for (const auto& buffer : buffers) count += buffer->dropped;
+    return count;
+}
+
+void TraceRecorder::writeJson(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : buffers) {
+        if (buffer->events.empty()) continue;
+
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":\"thread " << buffer->threadId << "\"}}";
+        first = false;
+
+        for (const TraceEvent& event : buffer->events) {
+            out << ",\n{\"name\":";
+            writeString(out, event.name);
+            out << ",\"cat\":";
+            writeString(out, event.category);
+            out << ",\"ph\":\"X\",\"ts\":" << std::fixed << std::setprecision(3)
+                << microseconds(event.begin - epoch)
+                << ",\"dur\":" << microseconds(event.duration) << std::defaultfloat
+                << ",\"pid\":1,\"tid\":" << buffer->threadId;
+            if (event.argName) {
+                out << ",\"args\":{";
+                writeString(out, event.argName);
+                out << ':' << std::setprecision(9) << event.argValue << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool TraceRecorder::writeJson(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+    writeJson(file);
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,81 @@
+#ifndef TRACE_EVENTS_H
+#define TRACE_EVENTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Timeline tracing in the Chrome trace-event format, viewable in
+// chrome://tracing or Perfetto.
+//
+//   TraceRecorder::start();
+//   ... run an analysis ...
+//   TraceRecorder::stop();
+//   TraceRecorder::writeJson("run.json");
+//
+// Every thread appends to its own buffer, so tracing concurrent analyses
+// takes no locks after a thread's first event. Event names and categories
+// must be string literals (only the pointer is stored). start(), stop() and
+// writeJson() must not race with threads that are still recording.
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Events kept per thread; later events are counted as dropped
+    static constexpr std::size_t maxEventsPerThread = std::size_t(1) << 20;
+
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    // Clears previous events and begins recording
+    static void start();
+    static void stop();
+
+    // One complete event (begin + duration) on the calling thread. argName
+    // may be null; otherwise argValue is attached as args.{argName}.
+    static void record(const char* name, const char* category,
+                       Clock::time_point begin, Clock::time_point end,
+                       const char* argName = nullptr, double argValue = 0.0);
+
+    static std::size_t eventCount();
+    static std::size_t droppedCount();
+
+    static void writeJson(std::ostream& out);
+    static bool writeJson(const std::string& filename);
+
+private:
+    static std::atomic<bool> active;
+};
+
+// Records the enclosing scope as one event when tracing is on; a single
+// relaxed load otherwise.
+class ScopedTraceEvent {
+private:
+    const char* name;
+    const char* category;
+    const char* argName;
+    double argValue;
+    bool tracing;
+    TraceRecorder::Clock::time_point begin;
+
+public:
+    ScopedTraceEvent(const char* name, const char* category,
+                     const char* argName = nullptr, double argValue = 0.0)
+        : name(name), category(category), argName(argName), argValue(argValue),
+          tracing(TraceRecorder::enabled()) {
+        if (tracing) begin = TraceRecorder::Clock::now();
+    }
+
+    ~ScopedTraceEvent() {
+        if (tracing) {
+            TraceRecorder::record(name, category, begin, TraceRecorder::Clock::now(), argName, argValue);
+        }
+    }
+
+    ScopedTraceEvent(const ScopedTraceEvent&) = delete;
+    ScopedTraceEvent& operator=(const ScopedTraceEvent&) = delete;
+};
+
+#endif